@@ -24,15 +24,24 @@
 void ide_init();
 int	ide_read(uint32 secno, void *dst, uint32 nsecs);
 int	ide_write(uint32 secno, const void *src, uint32 nsecs);
+//2025: vectored read/write: consecutive sectors from/to many buffers by a single command
+struct ide_segment
+{
+	void *va;
+	uint32 nsecs;
+};
+int	ide_readv(uint32 secno, struct ide_segment *segs, uint32 nsegs);
+int	ide_writev(uint32 secno, struct ide_segment *segs, uint32 nsegs);
 
 
 #define PROGRAMMED_IO 	1
 #define INT_SLEEP 		2
 #define INT_SEMAPHORE 	3
+#define DMA_BUS_MASTER 	4			//PIIX bus-master DMA: the env is blocked during the whole transfer (falls back to PROGRAMMED_IO if no PCI IDE controller)
 
 #define DISK_IO_METHOD PROGRAMMED_IO 	//Specify the method of handling the block/release on DISK
 
-#if DISK_IO_METHOD == INT_SLEEP
+#if DISK_IO_METHOD == INT_SLEEP || DISK_IO_METHOD == DMA_BUS_MASTER
 struct Channel DISKchannel;				//channel of waiting for DISK
 struct kspinlock DISKlock;				//spinlock to protect the DISKchannel
 struct sleeplock DISKmutex;				//mutex on ide_read/write
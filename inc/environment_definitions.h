@@ -114,9 +114,11 @@ struct Env {
 	int32 env_parent_id;			// env_id of this env's parent
 	unsigned env_status;			// Status of the environment
 	int priority;					// Current priority
+	int32 group_id;					// Group of cooperating envs that are co-scheduled together (0: no group)
 	char prog_name[PROGNAMELEN];	// Program name (to print it via USER.cprintf in multitasking)
 	void* channel;					// Address of the channel that it's blocked (sleep) on it
 	uint32 waiting_time;
+	uint8 promoted;					// Promoted (against starvation) in this clock tick, its group is boosted after the ready queues are scanned
 
 	//================
 	/*ADDRESS SPACE*/
@@ -193,6 +195,8 @@ struct Env {
 	//2020
 	uint32 nPageIn, nPageOut, nNewPageAdded;
 	uint32 nClocks ;
+	//2025: compressed swap (pages stored now, total stores & their total original/compressed bytes)
+	uint32 nZswapPages, nZswapStores, nZswapOrigBytes, nZswapCompBytes;
 
 };
 
@@ -28,6 +28,8 @@
 
 #define E_NO_TABLE -21					// Table not exists for the given VA
 
+#define E_AGAIN -22						// The futex word doesn't hold the expected value
+
 #define	MAXERROR	100
 
 #endif	// !FOS_INC_ERROR_H */
@@ -22,6 +22,8 @@
 #include <inc/uheap.h>
 #include <inc/dynamic_allocator.h>
 #include <inc/uspinlock.h>
+#include <inc/umutex.h>
+#include <inc/uchannel.h>
 
 #define USED(x)		(void)(x)
 #define RAND(s,e)	((sys_get_virtual_time().low % (e-s) + s))
@@ -53,6 +55,8 @@ int32	sys_getparentenvid(void);
 void 	sys_exit_env();
 //2016. Edited @ 2018 @2020 to add secondlist size for LRU list approximation
 int 	sys_create_env(char* programName, unsigned int page_WS_size,unsigned int LRU_second_list_size,unsigned int percent_WS_pages_to_remove);
+//2025
+int 	sys_create_env_in_group(char* programName, unsigned int page_WS_size,unsigned int LRU_second_list_size,unsigned int percent_WS_pages_to_remove, int32 groupID);
 int		sys_destroy_env(int32 envId);
 void	sys_run_env(int32 envId);
 
@@ -80,11 +84,18 @@ uint32 	sys_get_uheap_strategy();
 void 	sys_set_uheap_strategy(uint32 heapStrategy);
 
 void sys_env_set_priority(int32 envID, int priority);
+void sys_sleep(uint32 milliseconds);
 
 //Page File
 int 	sys_pf_calculate_allocated_pages(void);
 
 //Semaphores
+int 	sys_sem_wait(volatile int32* count);
+int 	sys_sem_signal(volatile int32* count);
+
+//Futex (block while *addr == expected / wakeup at most num waiters on addr)
+int 	sys_futex_wait(volatile int32* addr, int32 expected);
+int 	sys_futex_wake(volatile int32* addr, uint32 num);
 
 //Sharing
 //2017
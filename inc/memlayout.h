@@ -216,6 +216,9 @@ struct FrameInfo {
 	uint16 references;
 	struct Env *proc;
 	unsigned char isBuffered;
+	/*2025*/ //buddy allocator: set on the first frame of each free block only
+	unsigned char isFreeBlock;
+	unsigned char order;			//the block has (1 << order) frames
 };
 
 #endif /* !__ASSEMBLER__ */
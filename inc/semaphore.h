@@ -9,8 +9,8 @@ struct __semdata
 	//queue of all blocked envs on this Semaphore
 	struct Env_Queue queue;
 
-	//semaphore value
-	int count;
+	//semaphore value (negative: num of blocked envs)
+	volatile int32 count;
 
 	//lock variable protecting this count
 	uint32 lock;
@@ -53,6 +53,11 @@ enum
 	//TODO: [PROJECT'25.IM#4] CPU SCHEDULING - #1 System Calls - Add suitable code here
 	//Your code is here
 	SYS_env_set_priority,
+	SYS_sleep,
+	SYS_sem_wait,
+	SYS_sem_signal,
+	SYS_futex_wait,
+	SYS_futex_wake,
 
 	//=====================================================================
 	NSYSCALLS
@@ -0,0 +1,44 @@
+// User-level message channel: a bounded ring buffer in a shared object
+#ifndef INC_UCHANNEL_H_
+#define INC_UCHANNEL_H_
+
+//Kinds of the channel
+#define CHAN_SPSC		0		//single producer & single consumer (no atomic ops on the indices)
+#define CHAN_MPMC		1		//multiple producers & multiple consumers
+
+//Num of (pause) iterations to retry on a full/empty channel before blocking
+#define CHAN_SPIN_COUNT	100
+
+#define CHAN_CACHE_LINE	64
+
+//Each slot keeps a sequence number that tells whether it's ready to be written
+//(== pos) or read (== pos+1) at the position pos of the ring
+struct uchannel_slot {
+	volatile uint32 seq;
+	char data[];			// msg_size bytes
+};
+
+struct uchannel {
+	char name[NAMELEN];
+	uint32 kind;			// CHAN_SPSC or CHAN_MPMC
+	uint32 msg_size;		// size of each message (bytes)
+	uint32 capacity;		// num of slots (power of 2)
+	uint32 slot_size;		// size of each slot (bytes)
+	//the indices & the futex words are each on its own cache line (no false sharing)
+	volatile uint32 tail __attribute__((aligned(CHAN_CACHE_LINE)));	// next position to send on
+	volatile uint32 head __attribute__((aligned(CHAN_CACHE_LINE)));	// next position to receive from
+	volatile uint32 data_seq __attribute__((aligned(CHAN_CACHE_LINE)));	// futex word: bumped on each send when there're blocked receivers
+	volatile int32 recv_waiters;
+	volatile uint32 space_seq __attribute__((aligned(CHAN_CACHE_LINE)));	// futex word: bumped on each receive when there're blocked senders
+	volatile int32 send_waiters;
+	//followed by the slots
+	char slots[] __attribute__((aligned(CHAN_CACHE_LINE)));
+};
+
+struct uchannel* chan_create(char *name, uint32 kind, uint32 msg_size, uint32 capacity);
+struct uchannel* chan_get(int32 ownerEnvID, char *name);
+int  chan_try_send(struct uchannel *ch, const void *msg);
+int  chan_try_recv(struct uchannel *ch, void *msg);
+void chan_send(struct uchannel *ch, const void *msg);
+void chan_recv(struct uchannel *ch, void *msg);
+#endif /*INC_UCHANNEL_H_*/
@@ -0,0 +1,25 @@
+// User-level mutex (adaptive: spins briefly then blocks in the kernel)
+#ifndef INC_UMUTEX_H_
+#define INC_UMUTEX_H_
+
+//Set to 1 to print a line on each acquire/release (slow: each print is a syscall
+//that serializes on the console lock)
+#define UMUTEX_TRACE		0
+
+//Num of (pause) iterations to spin on a held mutex before blocking
+#define UMUTEX_SPIN_COUNT	100
+
+//Values of the mutex state
+#define UMUTEX_UNLOCKED		0
+#define UMUTEX_LOCKED		1		//locked, no waiters
+#define UMUTEX_CONTENDED	2		//locked, there may be blocked waiters
+
+struct umutex {
+  volatile uint32 state;	// one of the above values (the futex word)
+  char name[NAMELEN];		// Name of mutex.
+};
+void init_umutex(struct umutex *mtx, char *name, bool isOpened);
+void acquire_umutex(struct umutex *mtx);
+int  try_acquire_umutex(struct umutex *mtx);
+void release_umutex(struct umutex *mtx);
+#endif /*INC_UMUTEX_H_*/
@@ -29,7 +29,11 @@ static __inline void lcr2(uint32 val) __attribute__((always_inline));
 //2024
 static __inline void cli() __attribute__((always_inline));
 static __inline void sti() __attribute__((always_inline));
+static __inline void sti_hlt(void) __attribute__((always_inline));
 static __inline uint32 xchg(volatile uint32 *addr, uint32 newval) __attribute__((always_inline));
+static __inline int32 xadd(volatile int32 *addr, int32 val) __attribute__((always_inline));
+static __inline uint32 cmpxchg(volatile uint32 *addr, uint32 oldval, uint32 newval) __attribute__((always_inline));
+static __inline void cpu_pause(void) __attribute__((always_inline));
 static __inline void lgdt(struct Segdesc *p, int size) __attribute__((always_inline));
 static __inline void lidt(struct Gatedesc *p, int size) __attribute__((always_inline));
 //****************
@@ -48,6 +52,7 @@ static __inline void write_esp(uint32 esp) __attribute__((always_inline));
 static __inline void write_ebp(uint32 ebp) __attribute__((always_inline));
 static __inline void cpuid(uint32 info, uint32 *eaxp, uint32 *ebxp, uint32 *ecxp, uint32 *edxp);
 static __inline uint64 read_tsc(void) __attribute__((always_inline));
+static __inline void zero_page_nt(void *va) __attribute__((always_inline));
 static inline __attribute__((always_inline)) struct uint64 get_virtual_time_user();
 
 
@@ -331,6 +336,15 @@ sti(void)
 	__asm __volatile("sti");
 }
 
+//set interrupt flag then halt till the next interrupt
+//(sti delays the interrupts till the end of the next instruction, so no interrupt
+// can be lost between them)
+static __inline void
+sti_hlt(void)
+{
+	__asm __volatile("sti; hlt" : : : "memory");
+}
+
 //atomic xchange
 //Example: xchg(&(globalIntVar), 1);
 static __inline uint32
@@ -346,6 +360,54 @@ xchg(volatile uint32 *addr, uint32 newval)
   return result;
 }
 
+//atomic fetch & add: adds val to *addr & returns the OLD value of *addr
+//Example: int32 old = xadd(&(globalIntVar), 1);
+static __inline int32
+xadd(volatile int32 *addr, int32 val)
+{
+  __asm __volatile("lock; xaddl %0, %1" :
+               "+r" (val), "+m" (*addr) :
+               :
+               "memory", "cc");
+  return val;
+}
+
+//atomic compare & exchange: sets *addr to newval ONLY IF it equals oldval
+//returns the OLD value of *addr (i.e. succeeded if it's equal to oldval)
+//Example: if (cmpxchg(&(globalIntVar), 0, 1) == 0) {/*acquired*/}
+static __inline uint32
+cmpxchg(volatile uint32 *addr, uint32 oldval, uint32 newval)
+{
+  uint32 result;
+  __asm __volatile("lock; cmpxchgl %2, %1" :
+               "=a" (result), "+m" (*addr) :
+               "r" (newval), "0" (oldval) :
+               "memory", "cc");
+  return result;
+}
+
+//spin-wait hint (lowers the cost of the busy loop & the exit penalty from it)
+static __inline void
+cpu_pause(void)
+{
+	__asm __volatile("pause" : : : "memory");
+}
+
+//zero the given page (4KB-aligned) by non-temporal stores (SSE2 movnti): the zeros go
+//to the memory without filling the caches by a page that's not going to be used soon
+static __inline void
+zero_page_nt(void *va)
+{
+	uint32 *p = (uint32 *)va;
+	for (int i = 0; i < 1024; i += 4)
+		__asm __volatile("movnti %1, (%0)\n\t"
+						 "movnti %1, 4(%0)\n\t"
+						 "movnti %1, 8(%0)\n\t"
+						 "movnti %1, 12(%0)"
+						 : : "r" (p + i), "r" (0) : "memory");
+	__asm __volatile("sfence" : : : "memory");
+}
+
 //load GDT register
 static __inline void
 lgdt(struct Segdesc *p, int size)
@@ -14,9 +14,16 @@
 #include <kern/proc/priority_manager.h>
 #include <kern/tests/utilities.h>
 #include "../cpu/sched.h"
+#include "../cpu/kclock.h"
+#include "../cpu/sched_trace.h"
+#include "../conc/lockstat.h"
+#include "../disk/disk_queue.h"
+#include "../disk/pf_cache.h"
+#include "../disk/zswap.h"
 #include "../disk/pagefile_manager.h"
 #include "../mem/kheap.h"
 #include "../mem/memory_manager.h"
+#include "../mem/shared_memory_manager.h"
 #include "../tests/tst_handler.h"
 #include "../tests/utilities.h"
 #include "../cons/console.h"
@@ -69,6 +76,10 @@ struct Command commands[] =
 		{"modbuff", "enable modified buffer", command_enable_modified_buffer, 0},
 		{"modbufflength?", "get modified buffer length", command_get_modified_buffer_length, 0},
 		{"cls", "clear screen", command_cls, 0},
+		{"schedtrace", "print histograms of wait latency & quantum utilization per priority from the scheduler trace", command_sched_trace, 0},
+		{"schedtraceclr", "clear the scheduler trace", command_sched_trace_clear, 0},
+		{"lockstat", "print then reset the contention statistics of the kernel spin & sleep locks (& the per-CPU frame caches)", command_lockstat, 0},
+		{"diskstat", "print the statistics of the disk request queue, the page file cache & the compressed swap", command_diskstat, 0},
 
 		//*****************************//
 		/* COMMANDS WITH ONE ARGUMENT */
@@ -87,6 +98,11 @@ struct Command commands[] =
 		{"lru", "set replacement algorithm to LRU", command_set_page_rep_LRU, 1},
 		{"modbufflength", "set the length of the modified buffer", command_set_modified_buffer_length, 1},
 		{ "setStarvThr", "set the the starvation threshold of priority scheduler", command_set_starve_thresh, 1},
+		{ "tickless", "turn on/off the tickless clock when there's a single READY env (1: on, 0: off)", command_set_tickless, 1},
+		{ "lazyshare", "turn on/off the lazy mapping of the new shared objects (frames are allocated & mapped on first touch) (1: on, 0: off)", command_set_lazy_sharing, 1},
+		{ "largeshare", "turn on/off mapping the new shared objects of 4MB multiples by large (4MB) pages (1: on, 0: off)", command_set_large_sharing, 1},
+		{ "zswapmax", "set the max size (in frames) of the compressed swap pool (0: keep only the same-filled pages there)", command_set_zswap_max, 1},
+		{ "colors", "set the num of page colors of the frame allocator (power of 2, 1: no page coloring)", command_set_frame_colors, 1},
 
 		//******************************//
 		/* COMMANDS WITH TWO ARGUMENTS */
@@ -517,18 +533,13 @@ int command_remove_table(int number_of_arguments, char **arguments)
 	uint32 table_pa = env->env_page_directory[PDX(address)] & 0xFFFFF000;
 
 	//remove the table
-	if(USE_KHEAP && !CHECK_IF_KERNEL_ADDRESS(va))
-	{
-		kfree((void*)kheap_virtual_address(table_pa));
-	}
-	else
 	{
 		// get the physical address and FrameInfo of the page table
 		struct FrameInfo *table_FrameInfo = to_frame_info(table_pa);
 		// set references of the table frame to 0 then free it by adding
-		// to the free frame list
+		// to the page tables pool (2025: even with the KHEAP)
 		table_FrameInfo->references = 0;
-		free_frame(table_FrameInfo);
+		free_page_table_frame(table_FrameInfo);
 	}
 
 	// set the corresponding entry in the directory to 0
@@ -596,6 +607,13 @@ int command_meminfo(int number_of_arguments, char **arguments)
 	struct freeFramesCounters counters =calculate_available_frames();
 	cprintf("Total available frames = %d\nFree Buffered = %d\nFree Not Buffered = %d\nModified = %d\n",
 			counters.freeBuffered+ counters.freeNotBuffered+ counters.modified, counters.freeBuffered, counters.freeNotBuffered, counters.modified);
+	cprintf("Free blocks by order (frames per block):");
+	for (int order = 0; order <= MAX_FRAME_ORDER; order++)
+		cprintf(" %d:%d", 1 << order, counters.freeBlocks[order]);
+	cprintf("\nLargest free block = %d frames\n", counters.largestFreeOrder < 0 ? 0 : 1 << counters.largestFreeOrder);
+	zeroed_frames_print_stats();
+	frame_colors_print_stats();
+	page_table_frames_print_stats();
 
 	cprintf("Num of calls for kheap_virtual_address [in last run] = %d\n", numOfKheapVACalls);
 
@@ -961,6 +979,91 @@ int command_sch_test(int number_of_arguments, char **arguments)
 		cprintf("Testing the scheduler is TURNED ON\n");
 	return 0;
 }
+int command_sched_trace(int number_of_arguments, char **arguments)
+{
+	sched_trace_print();
+	return 0;
+}
+int command_sched_trace_clear(int number_of_arguments, char **arguments)
+{
+	sched_trace_reset();
+	cprintf("Scheduler trace is cleared\n");
+	return 0;
+}
+int command_lockstat(int number_of_arguments, char **arguments)
+{
+	lockstat_print(1);
+	frame_cache_print_stats(1);
+	return 0;
+}
+int command_diskstat(int number_of_arguments, char **arguments)
+{
+	disk_queue_print_stats();
+	pf_cache_print_stats();
+	zswap_print_stats();
+	return 0;
+}
+int command_set_zswap_max(int number_of_arguments, char **arguments)
+{
+	int nframes = strtol(arguments[1], NULL, 10);
+	zswap_set_max_pool_frames(nframes < 0 ? 0 : nframes);
+	cprintf("Max size of the compressed swap pool = %d frames\n", ZSwap.max_pool_frames);
+	return 0;
+}
+int command_set_frame_colors(int number_of_arguments, char **arguments)
+{
+	int num_of_colors = strtol(arguments[1], NULL, 10);
+	if (num_of_colors <= 0 || set_num_of_frame_colors(num_of_colors) != 0)
+	{
+		cprintf("invalid num of colors: it should be a power of 2 in [1, %d]\n", MAX_FRAME_COLORS);
+		return 0;
+	}
+	if (get_num_of_frame_colors() == 1)
+		cprintf("Page coloring is TURNED OFF\n");
+	else
+		cprintf("Page coloring is TURNED ON with %d colors\n", get_num_of_frame_colors());
+	return 0;
+}
+int command_set_tickless(int number_of_arguments, char **arguments)
+{
+	int status  = strtol(arguments[1], NULL, 10);
+	kclock_enable_tickless(status != 0);
+	if (kclock_is_tickless_enabled())
+		cprintf("Tickless clock is TURNED ON\n");
+	else
+		cprintf("Tickless clock is TURNED OFF\n");
+	return 0;
+}
+int command_set_lazy_sharing(int number_of_arguments, char **arguments)
+{
+#if USE_KHEAP == 0
+	//shared objects (incl. their lazy attachments) are compiled out without the kernel heap
+	cprintf("ERROR: shared objects are not handled when KERN HEAP is disabled (USE_KHEAP = 0)\n");
+	return 0;
+#endif
+	int status  = strtol(arguments[1], NULL, 10);
+	enableLazySharing(status != 0);
+	if (isLazySharingEnabled())
+		cprintf("Lazy mapping of shared objects is TURNED ON\n");
+	else
+		cprintf("Lazy mapping of shared objects is TURNED OFF\n");
+	return 0;
+}
+int command_set_large_sharing(int number_of_arguments, char **arguments)
+{
+#if USE_KHEAP == 0
+	//large frames are only used by the shared objects, which are compiled out without the kernel heap
+	cprintf("ERROR: shared objects are not handled when KERN HEAP is disabled (USE_KHEAP = 0)\n");
+	return 0;
+#endif
+	int status  = strtol(arguments[1], NULL, 10);
+	enableLargeSharing(status != 0);
+	if (isLargeSharingEnabled())
+		cprintf("Large (4MB) pages of shared objects are TURNED ON\n");
+	else
+		cprintf("Large (4MB) pages of shared objects are TURNED OFF\n");
+	return 0;
+}
 
 /*2018*///END======================================================
 
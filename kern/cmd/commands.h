@@ -146,5 +146,15 @@ int command_sch_test(int number_of_arguments, char **arguments);
 int command_set_priority(int number_of_arguments, char **arguments);
 int command_sch_PRIRR(int number_of_arguments, char **arguments);
 int command_set_starve_thresh(int number_of_arguments, char **arguments);
+//2025
+int command_set_tickless(int number_of_arguments, char **arguments);
+int command_sched_trace(int number_of_arguments, char **arguments);
+int command_sched_trace_clear(int number_of_arguments, char **arguments);
+int command_lockstat(int number_of_arguments, char **arguments);
+int command_diskstat(int number_of_arguments, char **arguments);
+int command_set_lazy_sharing(int number_of_arguments, char **arguments);
+int command_set_large_sharing(int number_of_arguments, char **arguments);
+int command_set_zswap_max(int number_of_arguments, char **arguments);
+int command_set_frame_colors(int number_of_arguments, char **arguments);
 
 #endif /* KERN_CMD_COMMANDS_H_ */
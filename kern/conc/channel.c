@@ -10,6 +10,8 @@
 #include <inc/string.h>
 #include <inc/disk.h>
 #include <kern/conc/kspinlock.h>
+#include <kern/cpu/timer_wheel.h>
+#include <kern/cpu/sched_trace.h>
 
 //===============================
 // 1) INITIALIZE THE CHANNEL:
@@ -42,6 +44,8 @@ void sleep(struct Channel *chan, struct kspinlock* lk)
 
 	    enqueue(&chan->queue, pros1);
 	    pros1->env_status = ENV_BLOCKED;
+	    ProcessQueues.num_of_blocked++;
+	    sched_trace(pros1, STRC_BLOCK);
 
 
 	    release_kspinlock(lk);
@@ -73,6 +77,8 @@ void wakeup_one(struct Channel *chan)
 	    if (siZe > 0) {
 	        struct Env *pros2 = dequeue(&chan->queue);
 	        pros2->env_status = ENV_READY;
+	        ProcessQueues.num_of_blocked--;
+	        sched_trace(pros2, STRC_WAKEUP);
 	        sched_insert_ready(pros2);
 	    }
 
@@ -104,6 +110,8 @@ void wakeup_all(struct Channel *chan)
 	    while ((pros3 = dequeue(&chan->queue)) != NULL)
 	    {
 	        pros3->env_status = ENV_READY;
+	        ProcessQueues.num_of_blocked--;
+	        sched_trace(pros3, STRC_WAKEUP);
 	        sched_insert_ready(pros3);
 	    }
 
@@ -115,3 +123,39 @@ void wakeup_all(struct Channel *chan)
 	//panic("wakeup_all() is not implemented yet...!!");
 }
 
+//====================================================
+// 5) SLEEP ON A GIVEN CHANNEL WITH TIMEOUT:
+//====================================================
+// Same as sleep() but the process is woken up by the clock (via the timer wheel)
+// if no wakeup occurs on the chan within the given timeout.
+// Returns 1 if woken up due to the timeout, 0 otherwise
+int sleep_timeout(struct Channel *chan, struct kspinlock* lk, uint32 timeout_ms)
+{
+	struct Env* p = get_cpu_proc();
+	if (p == NULL)
+		panic("sleep_timeout: no running process!");
+
+	//the timer lives on the kernel stack of the process till it's woken up
+	struct Timer t;
+
+	acquire_kspinlock(&ProcessQueues.qlock);
+	{
+		enqueue(&chan->queue, p);
+		p->env_status = ENV_BLOCKED;
+		ProcessQueues.num_of_blocked++;
+		sched_trace(p, STRC_BLOCK);
+		timer_add(&t, p, chan, timer_ms_to_ticks(timeout_ms));
+
+		release_kspinlock(lk);
+
+		sched();
+
+		//woken up by a wakeup on the chan before the timer expires
+		timer_cancel(&t);
+
+		acquire_kspinlock(lk);
+	}
+	release_kspinlock(&ProcessQueues.qlock);
+
+	return t.expired;
+}
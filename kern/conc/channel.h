@@ -21,6 +21,7 @@ void init_channel(struct Channel *chan, char *name);
 void sleep(struct Channel *chan, struct kspinlock* lk); 	//block the running process on the given channel (queue) using the given lk
 void wakeup_one(struct Channel *chan);					//wakeup ONE blocked process on the given channel (queue)
 void wakeup_all(struct Channel *chan);					//wakeup ALL blocked processes on the given channel (queue)
+int sleep_timeout(struct Channel *chan, struct kspinlock* lk, uint32 timeout_ms);	//same as sleep() but for at most the given ms (returns 1 if timed out)
 
 
 #endif /* KERN_CONC_CHANNEL_H_ */
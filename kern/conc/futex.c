@@ -0,0 +1,244 @@
+// Wait queues of the user-level synchronization
+//
+// The user word (e.g. the count of a semaphore that's created by smalloc) is
+// identified by the physical address that backs it (i.e. FrameInfo + offset), so
+// all the envs that share its frame meet on the same wait queue whatever the VA
+// it's mapped on. The wait queues are hashed into buckets & allocated on demand
+// from a fixed pool; a queue is returned to the pool once it has no waiters & no
+// pending wakeups. If the pool is empty, the caller blocks till a queue is returned
+// then tries again (so the wait/wakeup never fails because of the pool size).
+
+#include "inc/types.h"
+#include "inc/x86.h"
+#include "inc/memlayout.h"
+#include "inc/mmu.h"
+#include "inc/error.h"
+#include "inc/assert.h"
+#include "inc/string.h"
+#include "futex.h"
+#include "channel.h"
+#include "../cpu/cpu.h"
+#include "../proc/user_environment.h"
+#include "../mem/memory_manager.h"
+
+static struct futex_waitq waitqs[FUTEX_MAX_WAITQS];
+static struct futex_waitq_list buckets[FUTEX_NUM_BUCKETS];
+static struct futex_waitq_list free_waitqs;
+static struct Channel free_waitqs_chan;	//envs waiting for a free wait queue
+static struct kspinlock futex_lock;		//protects all the buckets & wait queues
+
+void futex_init()
+{
+	init_kspinlock(&futex_lock, "futex lock");
+	LIST_INIT(&free_waitqs);
+	init_channel(&free_waitqs_chan, "futex free waitqs channel");
+	for (int b = 0; b < FUTEX_NUM_BUCKETS; b++)
+		LIST_INIT(&buckets[b]);
+	for (int i = 0; i < FUTEX_MAX_WAITQS; i++)
+	{
+		init_channel(&(waitqs[i].chan), "futex channel");
+		LIST_INSERT_HEAD(&free_waitqs, &waitqs[i]);
+	}
+}
+
+static inline uint32 futex_hash(uint32 key)
+{
+	//words of the same frame are spread over the buckets by their offset
+	return ((key >> 2) ^ (key >> PGSHIFT)) & (FUTEX_NUM_BUCKETS - 1);
+}
+
+//=====================================================
+// Get the key (physical address) of the given user VA in the current env
+// Returns 0 on success, E_INVAL if it's not mapped
+//=====================================================
+int futex_key(void* user_va, uint32* key)
+{
+	struct Env* cur_env = get_cpu_proc();
+	assert(cur_env != NULL);
+
+	uint32 va = (uint32)user_va;
+	if (va >= USER_TOP || (va & 3) != 0)
+		return E_INVAL;
+
+	uint32* ptr_page_table = NULL;
+	struct FrameInfo* ptr_frame_info = get_frame_info(cur_env->env_page_directory, va, &ptr_page_table);
+	if (ptr_frame_info == NULL)
+		return E_INVAL;
+
+	*key = to_physical_address(ptr_frame_info) + PGOFF(va);
+	return 0;
+}
+
+//Find the wait queue of the given key (& allocate it if not exist and alloc = 1)
+//Returns NULL if not exist & alloc = 0
+//If there's no free wait queue, it blocks till one is returned to the pool then
+//returns NULL: the caller should re-check its state (the futex_lock is released
+//while blocked) then try again
+//The futex_lock MUST be held
+static struct futex_waitq* futex_lookup(uint32 key, int alloc)
+{
+	struct futex_waitq_list* bucket = &buckets[futex_hash(key)];
+	struct futex_waitq* wq = NULL;
+	for (wq = LIST_FIRST(bucket); wq != NULL; wq = LIST_NEXT(wq))
+	{
+		if (wq->key == key)
+			return wq;
+	}
+	if (!alloc)
+		return NULL;
+
+	wq = LIST_FIRST(&free_waitqs);
+	if (wq == NULL)
+	{
+		//(FUTEX_MAX_WAITQS words already have waiters or pending wakeups)
+		sleep(&free_waitqs_chan, &futex_lock);
+		return NULL;
+	}
+	LIST_REMOVE(&free_waitqs, wq);
+	wq->key = key;
+	wq->tokens = 0;
+	wq->num_of_waiters = 0;
+	LIST_INSERT_HEAD(bucket, wq);
+	return wq;
+}
+
+//Return the given wait queue to the pool if it's no longer used
+//The futex_lock MUST be held
+static void futex_release_waitq(struct futex_waitq* wq)
+{
+	if (wq->num_of_waiters == 0 && wq->tokens == 0)
+	{
+		LIST_REMOVE(&buckets[futex_hash(wq->key)], wq);
+		LIST_INSERT_HEAD(&free_waitqs, wq);
+		if (queue_size(&(free_waitqs_chan.queue)) > 0)
+			wakeup_all(&free_waitqs_chan);
+	}
+}
+
+//=====================================================
+// Block the current env on the given user word till a sem_wakeup() on it
+// (returns immediately if a wakeup is already posted on it)
+// Returns 0 when woken up, E_INVAL if not mapped
+//=====================================================
+int sem_block(void* user_va)
+{
+	uint32 key;
+	int ret = futex_key(user_va, &key);
+	if (ret != 0)
+		return ret;
+
+	acquire_kspinlock(&futex_lock);
+	{
+		struct futex_waitq* wq;
+		while ((wq = futex_lookup(key, 1)) == NULL)
+			/* a wait queue is freed, try again */;
+		if (wq->tokens > 0)
+		{
+			//the signaler is already passed: consume its wakeup
+			wq->tokens--;
+		}
+		else
+		{
+			wq->num_of_waiters++;
+			sleep(&(wq->chan), &futex_lock);
+			wq->num_of_waiters--;
+		}
+		futex_release_waitq(wq);
+	}
+	release_kspinlock(&futex_lock);
+	return 0;
+}
+
+//=====================================================
+// Wakeup ONE env blocked on the given user word
+// (or post a wakeup if the waiter is not yet blocked)
+// Returns 0 on success, E_INVAL if not mapped
+//=====================================================
+int sem_wakeup(void* user_va)
+{
+	uint32 key;
+	int ret = futex_key(user_va, &key);
+	if (ret != 0)
+		return ret;
+
+	acquire_kspinlock(&futex_lock);
+	{
+		struct futex_waitq* wq;
+		while ((wq = futex_lookup(key, 1)) == NULL)
+			/* a wait queue is freed, try again */;
+		if (queue_size(&(wq->chan.queue)) > 0)
+		{
+			wakeup_one(&(wq->chan));
+		}
+		else
+		{
+			wq->tokens++;
+		}
+		futex_release_waitq(wq);
+	}
+	release_kspinlock(&futex_lock);
+	return 0;
+}
+
+//=====================================================
+// Block the current env on the given user word ONLY IF it still holds the
+// expected value (checked under the futex_lock, so a futex_wake() that follows
+// the change of the word can't be missed)
+// Returns 0 when woken up, E_AGAIN if the word is changed, E_INVAL if not mapped
+//=====================================================
+int futex_wait(void* user_va, int32 expected)
+{
+	uint32 key;
+	int ret = futex_key(user_va, &key);
+	if (ret != 0)
+		return ret;
+
+	acquire_kspinlock(&futex_lock);
+	{
+		struct futex_waitq* wq;
+		do
+		{
+			//(re-checked after waiting for a free wait queue)
+			if (*((volatile int32*)user_va) != expected)
+			{
+				release_kspinlock(&futex_lock);
+				return E_AGAIN;
+			}
+		} while ((wq = futex_lookup(key, 1)) == NULL);
+		wq->num_of_waiters++;
+		sleep(&(wq->chan), &futex_lock);
+		wq->num_of_waiters--;
+		futex_release_waitq(wq);
+	}
+	release_kspinlock(&futex_lock);
+	return 0;
+}
+
+//=====================================================
+// Wakeup (at most) num envs blocked on the given user word
+// Returns the num of woken envs, E_INVAL if not mapped
+//=====================================================
+int futex_wake(void* user_va, uint32 num)
+{
+	uint32 key;
+	int ret = futex_key(user_va, &key);
+	if (ret != 0)
+		return ret;
+
+	int cnt = 0;
+	acquire_kspinlock(&futex_lock);
+	{
+		//no wait queue => no waiters (nothing is posted, unlike sem_wakeup)
+		struct futex_waitq* wq = futex_lookup(key, 0);
+		if (wq != NULL)
+		{
+			while (cnt < num && queue_size(&(wq->chan.queue)) > 0)
+			{
+				wakeup_one(&(wq->chan));
+				cnt++;
+			}
+		}
+	}
+	release_kspinlock(&futex_lock);
+	return cnt;
+}
@@ -0,0 +1,33 @@
+// Wait queues of the user-level synchronization, keyed by the shared frame
+#ifndef KERN_CONC_FUTEX_H_
+#define KERN_CONC_FUTEX_H_
+
+#include <inc/queue.h>
+#include <kern/conc/channel.h>
+#include "kspinlock.h"
+
+#define FUTEX_NUM_BUCKETS	64		/* MUST be power of 2 */
+#define FUTEX_MAX_WAITQS	256		/* max num of user words that have waiters (or pending wakeups) at a time */
+
+struct futex_waitq
+{
+	uint32 key;					//physical address of the user word (frame + offset)
+	int32 tokens;				//wakeups posted while no env is waiting (consumed by the next wait)
+	uint32 num_of_waiters;		//num of envs blocked on the chan
+	struct Channel chan;		//channel to hold the blocked envs
+	LIST_ENTRY(futex_waitq) prev_next_info;
+};
+LIST_HEAD(futex_waitq_list, futex_waitq);
+
+void futex_init();
+int futex_key(void* user_va, uint32* key);
+
+//Semaphore-like wait/wake (used by the user-level semaphores)
+int sem_block(void* user_va);
+int sem_wakeup(void* user_va);
+
+//Generic futex wait/wake (used to build any user-level blocking synchronization)
+int futex_wait(void* user_va, int32 expected);
+int futex_wake(void* user_va, uint32 num);
+
+#endif /*KERN_CONC_FUTEX_H_*/
@@ -73,4 +73,23 @@ void signal_ksemaphore(struct ksemaphore *ksem)
 
 }
 
-
+//Same as wait_ksemaphore() but gives up after the given timeout
+//Returns 1 if timed out (without acquiring the semaphore), 0 otherwise
+int wait_ksemaphore_timeout(struct ksemaphore *ksem, uint32 timeout_ms)
+{
+	int timed_out = 0;
+	acquire_kspinlock(&ksem->lk);
+	{
+		ksem->count--;
+		if (ksem->count < 0)
+		{
+			timed_out = sleep_timeout(&ksem->chan, &ksem->lk, timeout_ms);
+
+			//it's no longer waiting on the semaphore, so give back its count
+			if (timed_out)
+				ksem->count++;
+		}
+	}
+	release_kspinlock(&ksem->lk);
+	return timed_out;
+}
@@ -18,5 +18,6 @@ struct ksemaphore
 void init_ksemaphore(struct ksemaphore *ksem, int value, char *name);
 void wait_ksemaphore(struct ksemaphore *ksem);
 void signal_ksemaphore(struct ksemaphore *ksem);
+int wait_ksemaphore_timeout(struct ksemaphore *ksem, uint32 timeout_ms);
 
 #endif /*KERN_CONC_KSEMAPHORE_H_*/
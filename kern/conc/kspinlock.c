@@ -18,11 +18,15 @@ void init_kspinlock(struct kspinlock *lk, char *name)
 {
 	strcpy(lk->name, name);
 	lk->locked = 0;
+	lk->next_ticket = 0;
+	lk->now_serving = 0;
 	lk->cpu = 0;
+	lockstat_reset(&lk->stats);
+	lockstat_register_kspinlock(lk);
 }
 
 // Acquire the lock.
-// Loops (spins) until the lock is acquired.
+// Takes a ticket then loops (spins) until it's served (FIFO order).
 // Holding a lock for a long time may cause
 // other CPUs to waste time spinning to acquire it.
 void acquire_kspinlock(struct kspinlock *lk)
@@ -40,8 +44,23 @@ void acquire_kspinlock(struct kspinlock *lk)
 	if (e) envID = e->env_id;
 	//cprintf("[%d] try to acquire spinlock [%s]\n", envID, lk->name);
 
-	// The xchg is atomic.
-	while(xchg(&lk->locked, 1) != 0) ;
+	// The xadd is atomic: each acquirer gets a unique ticket.
+	uint32 my_ticket = (uint32)xadd((volatile int32*)&lk->next_ticket, 1);
+#if LOCKSTAT_ENABLED
+	bool contended = 0;
+	uint64 wait_cycles = 0;
+	if (lk->now_serving != my_ticket)
+	{
+		contended = 1;
+		uint64 wait_start = read_tsc();
+		while(lk->now_serving != my_ticket)
+			cpu_pause();
+		wait_cycles = read_tsc() - wait_start;
+	}
+#else
+	while(lk->now_serving != my_ticket)
+		cpu_pause();
+#endif
 
 	//cprintf("SPIN lock [%s] is ACQUIRED  by [%d]\n", lk->name, envID);
 
@@ -51,8 +70,14 @@ void acquire_kspinlock(struct kspinlock *lk)
 	__sync_synchronize();
 
 	// Record info about lock acquisition for debugging.
+	lk->locked = 1;
 	lk->cpu = mycpu();
+#if KSPINLOCK_DEBUG
 	getcallerpcs(&lk, lk->pcs);
+#endif
+#if LOCKSTAT_ENABLED
+	lockstat_acquired(&lk->stats, (uint32)__builtin_return_address(0), contended, wait_cycles);
+#endif
 
 }
 
@@ -64,7 +89,13 @@ void release_kspinlock(struct kspinlock *lk)
 		printcallstack(lk);
 		panic("release: lock \"%s\" is either not held or held by another CPU!", lk->name);
 	}
+#if KSPINLOCK_DEBUG
 	lk->pcs[0] = 0;
+#endif
+#if LOCKSTAT_ENABLED
+	lockstat_released(&lk->stats);
+#endif
+	lk->locked = 0;
 	lk->cpu = 0;
 
 	// Tell the C compiler and the processor to not move loads or stores
@@ -74,10 +105,10 @@ void release_kspinlock(struct kspinlock *lk)
 	// stores; __sync_synchronize() tells them both not to.
 	__sync_synchronize();
 
-	// Release the lock, equivalent to lk->locked = 0.
-	// This code can't use a C assignment, since it might
-	// not be atomic. A real OS would use C atomics here.
-	asm volatile("movl $0, %0" : "+m" (lk->locked) : );
+	// Release the lock: serve the next ticket.
+	// Only the holder writes now_serving, so an aligned 32-bit store is enough
+	// (no lock prefix needed).
+	asm volatile("movl %1, %0" : "+m" (lk->now_serving) : "r" (lk->now_serving + 1));
 
 	int envID = 0;
 	struct Env *e = get_cpu_proc() ;
@@ -8,15 +8,26 @@
 
 #include <inc/types.h>
 #include <inc/stdio.h>
+#include "lockstat.h"
 
+//Set to 1 to record the call stack (pcs[]) of the holder on each acquire
+//(walks 10 frames of the ebp chain inside the critical path of every lock)
+#define KSPINLOCK_DEBUG 0
+
+/*2025: ticket lock: each acquirer takes the next ticket (atomic fetch&add) then
+ * spins (reading only) till it's served => FIFO fairness & a single atomic op
+ * per acquire instead of an xchg storm on the same cache line*/
 struct kspinlock {
   uint32 locked;       	// Is the lock held?
+  volatile uint32 next_ticket;	// Ticket to be given to the next acquirer
+  volatile uint32 now_serving;	// Ticket of the current holder
 
   // For debugging:
   char name[NAMELEN];	// Name of lock.
   struct cpu *cpu;   	// The cpu holding the lock.
   uint32 pcs[10];      	// The call stack (an array of program counters)
-                     	// that locked the lock.
+                     	// that locked the lock. (only if KSPINLOCK_DEBUG)
+  struct lockstat stats;	// Contention statistics (only if LOCKSTAT_ENABLED)
 };
 void init_kspinlock(struct kspinlock *lk, char *name);
 void acquire_kspinlock(struct kspinlock *lk);
@@ -0,0 +1,140 @@
+// Contention statistics of the kernel locks
+//
+// Each kspinlock/sleeplock carries its own counters, updated by its holder (so
+// no extra locking is needed). The locks that are statically allocated in the
+// kernel image (the global ones, e.g. qlock, mfllock, the shares rwlock, DISKmutex) are
+// registered on their init so that "lockstat" can list them; locks on stacks or
+// inside dynamic objects still collect stats but are not listed.
+
+#include "inc/types.h"
+#include "inc/x86.h"
+#include "inc/memlayout.h"
+#include "inc/string.h"
+#include "inc/stdio.h"
+#include "lockstat.h"
+#include "kspinlock.h"
+#include "sleeplock.h"
+
+extern char end_of_kernel[];
+
+static struct kspinlock* spinlocks[LOCKSTAT_MAX_LOCKS];
+static uint32 num_of_spinlocks;
+static struct sleeplock* sleeplocks[LOCKSTAT_MAX_LOCKS];
+static uint32 num_of_sleeplocks;
+
+void lockstat_reset(struct lockstat *st)
+{
+	//keep the hold start (the lock may be currently held)
+	uint64 hold_start = st->hold_start;
+	memset(st, 0, sizeof(*st));
+	st->hold_start = hold_start;
+}
+
+void lockstat_acquired(struct lockstat *st, uint32 caller_pc, bool contended, uint64 wait_cycles)
+{
+	st->acquisitions++;
+	if (contended)
+	{
+		st->contended++;
+		st->wait_cycles += wait_cycles;
+	}
+
+	//Keep the most frequent call sites (space-saving: an unknown site replaces the least one)
+	int min = 0;
+	for (int i = 0; i < LOCKSTAT_TOP_PCS; i++)
+	{
+		if (st->top_pcs[i] == caller_pc)
+		{
+			st->top_cnts[i]++;
+			min = -1;
+			break;
+		}
+		if (st->top_cnts[i] < st->top_cnts[min])
+			min = i;
+	}
+	if (min >= 0)
+	{
+		st->top_pcs[min] = caller_pc;
+		st->top_cnts[min]++;
+	}
+
+	st->hold_start = read_tsc();
+}
+
+void lockstat_released(struct lockstat *st)
+{
+	uint64 held = read_tsc() - st->hold_start;
+	if (held > st->max_hold_cycles)
+		st->max_hold_cycles = held;
+}
+
+static inline bool is_static_lock(void *lk)
+{
+	return (uint32)lk >= KERNEL_BASE && (uint32)lk < (uint32)end_of_kernel;
+}
+
+void lockstat_register_kspinlock(struct kspinlock *lk)
+{
+	if (!is_static_lock(lk))
+		return;
+	for (int i = 0; i < num_of_spinlocks; i++)
+		if (spinlocks[i] == lk)
+			return;
+	if (num_of_spinlocks < LOCKSTAT_MAX_LOCKS)
+		spinlocks[num_of_spinlocks++] = lk;
+}
+
+void lockstat_register_sleeplock(struct sleeplock *lk)
+{
+	if (!is_static_lock(lk))
+		return;
+	for (int i = 0; i < num_of_sleeplocks; i++)
+		if (sleeplocks[i] == lk)
+			return;
+	if (num_of_sleeplocks < LOCKSTAT_MAX_LOCKS)
+		sleeplocks[num_of_sleeplocks++] = lk;
+}
+
+static void print_stat(char *name, struct lockstat *st)
+{
+	if (st->acquisitions == 0)
+		return;
+	uint32 avg_wait = st->contended ? (uint32)(st->wait_cycles / st->contended) : 0;
+	cprintf("%-36s %10d %10d %4d%% %12lld %10d %12lld\n", name,
+			st->acquisitions, st->contended, (st->contended * 100) / st->acquisitions,
+			st->wait_cycles, avg_wait, st->max_hold_cycles);
+	cprintf("%-36s", "    top holders:");
+	for (int i = 0; i < LOCKSTAT_TOP_PCS; i++)
+	{
+		if (st->top_cnts[i] > 0)
+			cprintf(" %x(%d)", st->top_pcs[i], st->top_cnts[i]);
+	}
+	cprintf("\n");
+}
+
+//=====================================================
+// Print the stats of all the registered locks [then reset them]
+// (times are in cycles)
+//=====================================================
+void lockstat_print(bool reset)
+{
+#if !LOCKSTAT_ENABLED
+	cprintf("lock statistics are compiled out (rebuild by: make DEFS=-DLOCKSTAT_ENABLED=1)\n");
+#else
+	cprintf("%-36s %10s %10s %5s %12s %10s %12s\n", "lock", "acquired", "contended", "", "wait", "avg wait", "max hold");
+	cprintf("---------------------------------------- spin locks ---------------------------------------------\n");
+	for (int i = 0; i < num_of_spinlocks; i++)
+		print_stat(spinlocks[i]->name, &(spinlocks[i]->stats));
+	cprintf("---------------------------------------- sleep locks --------------------------------------------\n");
+	for (int i = 0; i < num_of_sleeplocks; i++)
+		print_stat(sleeplocks[i]->name, &(sleeplocks[i]->stats));
+
+	if (reset)
+	{
+		for (int i = 0; i < num_of_spinlocks; i++)
+			lockstat_reset(&(spinlocks[i]->stats));
+		for (int i = 0; i < num_of_sleeplocks; i++)
+			lockstat_reset(&(sleeplocks[i]->stats));
+	}
+#endif
+}
@@ -0,0 +1,38 @@
+// Contention statistics of the kernel locks (used by the "lockstat" command)
+#ifndef KERN_CONC_LOCKSTAT_H_
+#define KERN_CONC_LOCKSTAT_H_
+
+#include <inc/types.h>
+
+//The statistics cost 2-4 rdtsc per acquire/release, so they're compiled out by default
+//(to enable them: make DEFS=-DLOCKSTAT_ENABLED=1)
+#ifndef LOCKSTAT_ENABLED
+#define LOCKSTAT_ENABLED	0
+#endif
+
+#define LOCKSTAT_TOP_PCS	4		/* num of the most frequent holder call sites to keep */
+#define LOCKSTAT_MAX_LOCKS	64		/* max num of registered spin/sleep locks */
+
+struct lockstat
+{
+	uint32 acquisitions;		//num of acquisitions
+	uint32 contended;			//num of acquisitions that had to wait (spin or sleep)
+	uint64 wait_cycles;			//total cycles spent waiting for the lock
+	uint64 max_hold_cycles;		//longest time the lock is held
+	uint64 hold_start;			//tsc at the last acquisition
+	uint32 top_pcs[LOCKSTAT_TOP_PCS];	//most frequent call sites of the holders
+	uint32 top_cnts[LOCKSTAT_TOP_PCS];	//(approx) num of acquisitions from each of them
+};
+
+struct kspinlock;
+struct sleeplock;
+
+void lockstat_reset(struct lockstat *st);
+void lockstat_acquired(struct lockstat *st, uint32 caller_pc, bool contended, uint64 wait_cycles);
+void lockstat_released(struct lockstat *st);
+
+void lockstat_register_kspinlock(struct kspinlock *lk);
+void lockstat_register_sleeplock(struct sleeplock *lk);
+void lockstat_print(bool reset);
+
+#endif /*KERN_CONC_LOCKSTAT_H_*/
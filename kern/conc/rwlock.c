@@ -0,0 +1,177 @@
+// Reader-writer locks
+
+#include "inc/types.h"
+#include "inc/x86.h"
+#include "inc/assert.h"
+#include "inc/string.h"
+#include "rwlock.h"
+#include "channel.h"
+#include "../cpu/cpu.h"
+#include "../proc/user_environment.h"
+
+//==========================================================================
+// [1] SPINNING RW LOCK
+//==========================================================================
+void init_krwlock(struct krwlock *rw, char *name)
+{
+	char prefix[30] = "lock of rwlock - ";
+	char guardName[30+NAMELEN];
+	strcconcat(prefix, name, guardName);
+	init_kspinlock(&(rw->lk), guardName);
+	strcpy(rw->name, name);
+	rw->readers = 0;
+	rw->waiting_writers = 0;
+	rw->writer = 0;
+	rw->writer_cpu = 0;
+}
+
+// Acquire the lock for read (shared with the other readers)
+// Interrupts are disabled till the release (as in kspinlock)
+void acquire_read_krwlock(struct krwlock *rw)
+{
+	if (holding_write_krwlock(rw))
+		panic("acquire_read_krwlock: lock \"%s\" is already held for write by the same CPU.", rw->name);
+
+	pushcli();
+	acquire_kspinlock(&rw->lk);
+	while (rw->writer || rw->waiting_writers > 0)
+	{
+		release_kspinlock(&rw->lk);
+		cpu_pause();
+		acquire_kspinlock(&rw->lk);
+	}
+	rw->readers++;
+	release_kspinlock(&rw->lk);
+}
+
+void release_read_krwlock(struct krwlock *rw)
+{
+	acquire_kspinlock(&rw->lk);
+	if (rw->readers == 0)
+		panic("release_read_krwlock: lock \"%s\" is not held for read!", rw->name);
+	rw->readers--;
+	release_kspinlock(&rw->lk);
+	popcli();
+}
+
+// Acquire the lock for write (exclusive)
+// Interrupts are disabled till the release (as in kspinlock)
+void acquire_write_krwlock(struct krwlock *rw)
+{
+	if (holding_write_krwlock(rw))
+		panic("acquire_write_krwlock: lock \"%s\" is already held by the same CPU.", rw->name);
+
+	pushcli();
+	acquire_kspinlock(&rw->lk);
+	rw->waiting_writers++;
+	while (rw->writer || rw->readers > 0)
+	{
+		release_kspinlock(&rw->lk);
+		cpu_pause();
+		acquire_kspinlock(&rw->lk);
+	}
+	rw->waiting_writers--;
+	rw->writer = 1;
+	rw->writer_cpu = mycpu();
+	release_kspinlock(&rw->lk);
+}
+
+void release_write_krwlock(struct krwlock *rw)
+{
+	if (!holding_write_krwlock(rw))
+		panic("release_write_krwlock: lock \"%s\" is either not held or held by another CPU!", rw->name);
+	acquire_kspinlock(&rw->lk);
+	rw->writer = 0;
+	rw->writer_cpu = 0;
+	release_kspinlock(&rw->lk);
+	popcli();
+}
+
+// Check whether this cpu is holding the lock for write.
+int holding_write_krwlock(struct krwlock *rw)
+{
+	int r;
+	pushcli();
+	r = rw->writer && rw->writer_cpu == mycpu();
+	popcli();
+	return r;
+}
+
+//==========================================================================
+// [2] SLEEPING RW LOCK
+//==========================================================================
+void init_sleeprwlock(struct sleeprwlock *rw, char *name)
+{
+	init_channel(&(rw->readers_chan), "rwlock readers channel");
+	init_channel(&(rw->writers_chan), "rwlock writers channel");
+	char prefix[30] = "lock of sleeprwlock - ";
+	char guardName[30+NAMELEN];
+	strcconcat(prefix, name, guardName);
+	init_kspinlock(&(rw->lk), guardName);
+	strcpy(rw->name, name);
+	rw->readers = 0;
+	rw->waiting_writers = 0;
+	rw->writer_pid = 0;
+}
+
+void acquire_read_sleeprwlock(struct sleeprwlock *rw)
+{
+	acquire_kspinlock(&rw->lk);
+	while (rw->writer_pid != 0 || rw->waiting_writers > 0)
+	{
+		sleep(&rw->readers_chan, &rw->lk);
+	}
+	rw->readers++;
+	release_kspinlock(&rw->lk);
+}
+
+void release_read_sleeprwlock(struct sleeprwlock *rw)
+{
+	acquire_kspinlock(&rw->lk);
+	if (rw->readers == 0)
+		panic("release_read_sleeprwlock: lock \"%s\" is not held for read!", rw->name);
+	rw->readers--;
+	//last reader: let a waiting writer in
+	if (rw->readers == 0 && rw->waiting_writers > 0)
+		wakeup_one(&rw->writers_chan);
+	release_kspinlock(&rw->lk);
+}
+
+void acquire_write_sleeprwlock(struct sleeprwlock *rw)
+{
+	acquire_kspinlock(&rw->lk);
+	rw->waiting_writers++;
+	while (rw->writer_pid != 0 || rw->readers > 0)
+	{
+		sleep(&rw->writers_chan, &rw->lk);
+	}
+	rw->waiting_writers--;
+	rw->writer_pid = get_cpu_proc()->env_id;
+	release_kspinlock(&rw->lk);
+}
+
+void release_write_sleeprwlock(struct sleeprwlock *rw)
+{
+	acquire_kspinlock(&rw->lk);
+	if (rw->writer_pid == 0 || rw->writer_pid != get_cpu_proc()->env_id)
+	{
+		release_kspinlock(&rw->lk);
+		panic("release_write_sleeprwlock: lock \"%s\" is not held for write by the current env!", rw->name);
+	}
+	rw->writer_pid = 0;
+	//writers first, else let all the waiting readers in
+	if (rw->waiting_writers > 0)
+		wakeup_one(&rw->writers_chan);
+	else
+		wakeup_all(&rw->readers_chan);
+	release_kspinlock(&rw->lk);
+}
+
+int holding_write_sleeprwlock(struct sleeprwlock *rw)
+{
+	int r;
+	acquire_kspinlock(&(rw->lk));
+	r = rw->writer_pid != 0 && (rw->writer_pid == get_cpu_proc()->env_id);
+	release_kspinlock(&(rw->lk));
+	return r;
+}
@@ -0,0 +1,51 @@
+// Reader-writer locks
+/* Many readers OR a single writer at a time. Writers are preferred: once a writer
+ * is waiting, new readers wait till it finishes (so a stream of readers can't starve it)
+ *
+ * krwlock: spinning variant (interrupts are disabled while it's held, as kspinlock)
+ * sleeprwlock: sleeping variant (the waiters are blocked on channels, as sleeplock)
+ * */
+#ifndef KERN_CONC_RWLOCK_H_
+#define KERN_CONC_RWLOCK_H_
+
+#include <kern/conc/channel.h>
+#include "kspinlock.h"
+
+struct krwlock
+{
+	struct kspinlock lk;		// spinlock protecting the fields below
+	uint32 readers;				// num of current readers
+	uint32 waiting_writers;		// num of writers waiting for the lock
+	bool writer;				// is it held by a writer?
+	struct cpu *writer_cpu;		// the cpu of the writer (for holding_write_krwlock)
+	// For debugging:
+	char name[NAMELEN];			// Name of lock.
+};
+
+void init_krwlock(struct krwlock *rw, char *name);
+void acquire_read_krwlock(struct krwlock *rw);
+void release_read_krwlock(struct krwlock *rw);
+void acquire_write_krwlock(struct krwlock *rw);
+void release_write_krwlock(struct krwlock *rw);
+int  holding_write_krwlock(struct krwlock *rw);
+
+struct sleeprwlock
+{
+	struct kspinlock lk;		// spinlock protecting the fields below
+	struct Channel readers_chan;// channel to hold the blocked readers
+	struct Channel writers_chan;// channel to hold the blocked writers
+	uint32 readers;				// num of current readers
+	uint32 waiting_writers;		// num of writers blocked on writers_chan
+	int writer_pid;				// env holding it for write (0 if none)
+	// For debugging:
+	char name[NAMELEN];			// Name of lock.
+};
+
+void init_sleeprwlock(struct sleeprwlock *rw, char *name);
+void acquire_read_sleeprwlock(struct sleeprwlock *rw);
+void release_read_sleeprwlock(struct sleeprwlock *rw);
+void acquire_write_sleeprwlock(struct sleeprwlock *rw);
+void release_write_sleeprwlock(struct sleeprwlock *rw);
+int  holding_write_sleeprwlock(struct sleeprwlock *rw);
+
+#endif /*KERN_CONC_RWLOCK_H_*/
@@ -22,6 +22,8 @@ void init_sleeplock(struct sleeplock *lk, char *name)
 	strcpy(lk->name, name);
 	lk->locked = 0;
 	lk->pid = 0;
+	lockstat_reset(&lk->stats);
+	lockstat_register_sleeplock(lk);
 }
 
 void acquire_sleeplock(struct sleeplock *lk)
@@ -31,6 +33,10 @@ void acquire_sleeplock(struct sleeplock *lk)
 
 	acquire_kspinlock(&lk->lk);
 
+#if LOCKSTAT_ENABLED
+	    bool contended = lk->locked;
+	    uint64 wait_start = contended ? read_tsc() : 0;
+#endif
 	    while (lk->locked) {
 
 	        sleep(&lk->chan, &lk->lk);
@@ -40,6 +46,9 @@ void acquire_sleeplock(struct sleeplock *lk)
 
 	    lk->locked = 1;
 	    lk->pid = get_cpu_proc()->env_id;
+#if LOCKSTAT_ENABLED
+	    lockstat_acquired(&lk->stats, (uint32)__builtin_return_address(0), contended, contended ? read_tsc() - wait_start : 0);
+#endif
 
 	    release_kspinlock(&lk->lk);
 
@@ -61,6 +70,9 @@ void release_sleeplock(struct sleeplock *lk)
 	    }
 
 	    	 else{
+#if LOCKSTAT_ENABLED
+	    lockstat_released(&lk->stats);
+#endif
 	    lk->locked = 0;
 	    lk->pid = 0;
 
@@ -16,6 +16,7 @@ struct sleeplock
 	// For debugging:
 	char name[NAMELEN];    	// Name of lock.
 	int pid;           		// Process holding lock
+	struct lockstat stats;	// Contention statistics (only if LOCKSTAT_ENABLED)
 };
 
 void init_sleeplock(struct sleeplock *lk, char *name);
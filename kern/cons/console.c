@@ -9,6 +9,7 @@
 #include <kern/proc/user_environment.h>
 #include <kern/cpu/sched_helpers.h>
 #include <kern/cpu/kclock.h>
+#include <kern/mem/memory_manager.h>
 #include <kern/conc/channel.h>
 
 #include "console.h"
@@ -510,7 +511,7 @@ getchar(void)
 	int c;
 
 	while ((c = cons_getc()) == 0)
-		/* do nothing */;
+		fill_zeroed_frames(1);		//2025: use the idle time to pre-zero some free frames
 	return c;
 }
 
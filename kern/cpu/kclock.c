@@ -39,6 +39,13 @@ mc146818_write(unsigned reg, unsigned datum)
  * (which depends on the mode).
  */
 
+//2025: tickless mode
+static uint8 kclock_tickless_enabled = 1;				//enable/disable the tickless mode (via "tickless" command)
+static uint8 kclock_tickless_state = KCLK_PERIODIC;	//current mode of the CNT0
+static uint8 kclock_cnt0_mode = TIMER_RATEGEN;			//PIT mode to use when resuming the CNT0
+static uint8 kclock_quantum = 0;						//last quantum set by kclock_set_quantum()
+static uint32 kclock_oneshot_ticks = 1;					//num of quantums covered by the current one-shot
+
 void kclock_init()
 {
 	ticks = 0;
@@ -149,6 +156,10 @@ kclock_resume(void)
 	 * the current count is copied into an internal "latch register" which can then be read via the data port corresponding to the selected channel (I/O ports 0x40 to 0x42). The value kept in the latch register remains the same until it has been fully read, or until a new mode/command register is written.
 	 * The main benefit of the latch command is that it allows both bytes of the current count to be read without inconsistencies. For example, if you didn't use the latch command, then the current count may decrease from 0x0200 to 0x01FF after you've read the low byte but before you've read the high byte, so that your software thinks the counter was 0x0100 instead of 0x0200 (or 0x01FF).
 	 */
+	//2025: tickless with no pending event: keep IRQ0 masked till someone exits the tickless mode
+	if (kclock_tickless_state == KCLK_TICKLESS_IDLE)
+		return ;
+
 	//uint16 cnt0 = kclock_read_cnt0() ;
 	uint16 cnt0 = kclock_read_cnt0_latch() ;
 	//cprintf("CLOCK RESUMED: Counter0 Value = %d\n", cnt0 );
@@ -162,7 +173,7 @@ kclock_resume(void)
 	if (cnt0 % 2 == 1)
 		cnt0++;
 
-	outb(TIMER_MODE, TIMER_SEL0 | TIMER_RATEGEN | TIMER_16BIT);
+	outb(TIMER_MODE, TIMER_SEL0 | kclock_cnt0_mode | TIMER_16BIT);
 	kclock_write_cnt0_LSB_first(cnt0) ;
 
 	//Busy-wait until the new cnt value is loaded from CR (Count Register) to CE (Count Element)
@@ -226,6 +237,12 @@ void kclock_set_quantum(uint8 quantum_in_ms)
 		outb(TIMER_MODE, TIMER_SEL0 | TIMER_RATEGEN | TIMER_16BIT);
 		kclock_write_cnt0_LSB_first(cnt) ;
 		kclock_stop();
+
+		//2025: back to the periodic mode
+		kclock_quantum = quantum_in_ms;
+		kclock_tickless_state = KCLK_PERIODIC;
+		kclock_cnt0_mode = TIMER_RATEGEN;
+		kclock_oneshot_ticks = 1;
 		//uint16 cnt0 = kclock_read_cnt0_latch() ; //read after write to ensure it's set to the desired value
 		//cprintf("\nkclock_set_quantum: clock after stop = %d\n",cnt0);
 	}
@@ -236,6 +253,85 @@ void kclock_set_quantum(uint8 quantum_in_ms)
 }
 //==============
 
+//2025
+//=====================================================================
+// Tickless mode:
+//	when the running env has no competitors in the ready queue(s), there's
+//	no need to interrupt it every quantum just to pick it again. Instead:
+//	1. if there's no future event, IRQ0 is kept masked (no clock interrupts)
+//	2. else, CNT0 is set to a one-shot (mode 0) that fires once on the next
+//	   event (e.g. LRU timestamps update) covering the given num of quantums
+//	The periodic mode is restored by kclock_exit_tickless() once a competitor
+//	becomes READY or by the next kclock_set_quantum()
+//=====================================================================
+void kclock_enable_tickless(uint8 enable)
+{
+	kclock_tickless_enabled = enable;
+	if (!enable)
+		kclock_exit_tickless();
+}
+
+uint8 kclock_is_tickless_enabled(void)
+{
+	return kclock_tickless_enabled;
+}
+
+uint8 kclock_is_tickless(void)
+{
+	return (kclock_tickless_state != KCLK_PERIODIC);
+}
+
+//Enter the tickless mode with the next event after the given num of quantums (0: no event)
+//Like kclock_set_quantum(), the IRQ0 is left masked till the next kclock_resume()
+void kclock_set_tickless(uint32 num_of_quantums)
+{
+	if (!kclock_tickless_enabled || kclock_quantum == 0)
+		return ;
+
+	if (num_of_quantums == 0)
+	{
+		kclock_stop();
+		kclock_tickless_state = KCLK_TICKLESS_IDLE;
+		kclock_oneshot_ticks = 1;
+		return ;
+	}
+
+	//the one-shot can't exceed the 16-bit CNT0 (i.e. QUANTUM_LIMIT ms)
+	uint32 max_quantums = (QUANTUM_LIMIT - 1) / kclock_quantum;
+	if (num_of_quantums > max_quantums)
+		num_of_quantums = max_quantums;
+
+	int cnt = NUM_CLKS_PER_QUANTUM(num_of_quantums * kclock_quantum);
+	outb(TIMER_MODE, TIMER_SEL0 | TIMER_INTTC | TIMER_16BIT);
+	kclock_write_cnt0_LSB_first(cnt) ;
+	kclock_stop();
+
+	kclock_tickless_state = KCLK_TICKLESS_ONESHOT;
+	kclock_cnt0_mode = TIMER_INTTC;
+	kclock_oneshot_ticks = num_of_quantums;
+}
+
+//Restore the periodic interrupts with the last quantum (if in tickless mode)
+void kclock_exit_tickless(void)
+{
+	if (kclock_tickless_state == KCLK_PERIODIC)
+		return ;
+	kclock_set_quantum(kclock_quantum);
+}
+
+//Last quantum set by kclock_set_quantum() (in ms)
+uint8 kclock_get_quantum(void)
+{
+	return kclock_quantum;
+}
+
+//Num of quantums elapsed since the last clock interrupt (> 1 only for tickless one-shots)
+uint32 kclock_ticks_per_interrupt(void)
+{
+	return kclock_oneshot_ticks;
+}
+//==============
+
 
 //2017
 void
@@ -49,6 +49,19 @@ void kclock_write_cnt0_LSB_first(uint16 val);
 //2018
 void kclock_set_quantum(uint8 quantum_in_ms);
 
+//2025: tickless mode
+#define KCLK_PERIODIC			0	/* interrupt every quantum */
+#define KCLK_TICKLESS_IDLE		1	/* no clock interrupts at all */
+#define KCLK_TICKLESS_ONESHOT	2	/* single interrupt on the next event */
+
+void kclock_enable_tickless(uint8 enable);
+uint8 kclock_is_tickless_enabled(void);
+uint8 kclock_is_tickless(void);
+void kclock_set_tickless(uint32 num_of_quantums);
+void kclock_exit_tickless(void);
+uint32 kclock_ticks_per_interrupt(void);
+uint8 kclock_get_quantum(void);
+
 
 extern uint32 virtualTime;
 
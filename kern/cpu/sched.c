@@ -10,6 +10,8 @@
 #include <kern/cmd/command_prompt.h>
 #include <kern/cpu/cpu.h>
 #include <kern/cpu/picirq.h>
+#include <kern/cpu/timer_wheel.h>
+#include <kern/cpu/sched_trace.h>
 
 
 uint32 isSchedMethodRR(){return (scheduler_method == SCH_RR);}
@@ -39,6 +41,8 @@ void sched_init()
 
 	init_queue(&ProcessQueues.env_new_queue);
 	init_queue(&ProcessQueues.env_exit_queue);
+	ProcessQueues.num_of_blocked = 0;
+	timer_wheel_init();
 
 	mycpu()->scheduler_status = SCH_STOPPED;
 
@@ -97,6 +101,16 @@ fos_scheduler(void)
 
 				//Change its status to RUNNING
 				next_env->env_status = ENV_RUNNING;
+				sched_trace(next_env, STRC_DISPATCH);
+
+				//2025: let the other members of its group (if any) follow it
+				sched_gang_dispatch(next_env);
+
+				//2025: Tickless: no other READY env, so no need to interrupt it every quantum
+				if (kclock_is_tickless_enabled() && !sched_any_ready())
+				{
+					kclock_set_tickless(sched_next_event_in_quantums());
+				}
 
 				//Context switch to it
 				context_switch(&(c->scheduler), next_env->context);
@@ -133,17 +147,19 @@ fos_scheduler(void)
 		} while(next_env);
 
 		//2024 - check if there's any blocked process?
-		is_any_blocked = 0;
-		for (int i = 0; i < NENV; ++i)
-		{
-			if (envs[i].env_status == ENV_BLOCKED)
-			{
-				is_any_blocked = 1;
-				break;
-			}
-		}
+		//counter is maintained by sleep() & wakeup_xxx() instead of scanning all the envs[]
+		is_any_blocked = (ProcessQueues.num_of_blocked > 0);
+
+		//Keep the interrupts disabled after releasing the lock so that a wakeup can't
+		//sneak in between the above check and halting the CPU below
+		pushcli();
 		release_kspinlock(&ProcessQueues.qlock);  //release lock: to protect ready & blocked Qs in multi-CPU
 		//cprintf("\n[FOS_SCHEDULER] release: lock status after = %d\n", qlock.locked);
+		if (is_any_blocked > 0)
+		{
+			sched_idle();
+		}
+		popcli();
 	} while (is_any_blocked > 0);
 
 	/*2015*///No more envs... curenv doesn't exist any more! return back to command prompt
@@ -154,6 +170,53 @@ fos_scheduler(void)
 
 }
 
+//=====================================
+// [2.1] Idle the CPU till an interrupt:
+//=====================================
+// Called by the scheduler when no env is READY while some are BLOCKED.
+// Instead of busy polling the queues, halt the CPU till an interrupt (e.g. KB or disk)
+// arrives and wakes up one of the blocked envs.
+// MUST be called with interrupts disabled & returns with interrupts disabled.
+void sched_idle(void)
+{
+	if (read_eflags() & FL_IF)
+		panic("sched_idle: called while the interrupt is enabled!");
+
+	//2025: use the idle time to pre-zero some free frames
+	fill_zeroed_frames(ZEROED_FILL_PER_IDLE);
+
+	//2025: if any env is in a timed sleep, let the clock run till its expiry
+	uint32 next_timer = timer_next_expiry();
+	if (next_timer > 0)
+	{
+		kclock_set_quantum(kclock_get_quantum());
+		kclock_set_tickless(next_timer);
+		kclock_resume();
+	}
+
+	sti_hlt();
+	cli();
+
+	if (next_timer > 0)
+	{
+		kclock_stop();
+	}
+}
+
+//=============================================
+// [2.2] Num of quantums till the next clock event:
+//=============================================
+// Used by the tickless mode to decide when the running env (with no competitors)
+// should be interrupted. 0 means there's no event at all.
+uint32 sched_next_event_in_quantums(void)
+{
+	//LRU time approx. should update the WS timestamps every quantum
+	if(isPageReplacmentAlgorithmLRU(PG_REP_LRU_TIME_APPROX))
+		return 1;
+	//2025: expiry of the next timed sleep (if any)
+	return timer_next_expiry();
+}
+
 //=============================
 // [3] Initialize RR Scheduler:
 //=============================
@@ -376,6 +439,9 @@ void clock_interrupt_handler(struct Trapframe* tf)
 		//Your code is here
 			        acquire_kspinlock(&ProcessQueues.qlock);
 
+			        //2025: envs promoted below are flagged (to boost their groups after the loop)
+			        int num_of_promoted = 0;
+
 			        for (int S = 0; S < num_of_ready_queues; S++)
 			        {
 			            struct Env_Queue* q = &(ProcessQueues.env_ready_queues[S]);
@@ -409,6 +475,8 @@ void clock_interrupt_handler(struct Trapframe* tf)
 		        	   // struct Env_Queue* higherQ = &(ProcessQueues.env_ready_queues[e->priority]);
 		        	    sched_insert_ready(e);
 		        	  //  higherQ->size++;
+		        	    e->promoted = 1;
+		        	    num_of_promoted++;
 		        	}
 
 
@@ -427,10 +495,26 @@ void clock_interrupt_handler(struct Trapframe* tf)
 		//Comment the following line
 		//panic("clock_interrupt_handler() is not implemented yet...!!");
 
+		   for (int i = 0; i < NENV && num_of_promoted > 0; i++)
+		   {
+			   if (envs[i].promoted)
+			   {
+				   envs[i].promoted = 0;
+				   num_of_promoted--;
+				   sched_boost_group(&envs[i]);
+			   }
+		   }
+
 		   release_kspinlock(&ProcessQueues.qlock);
 
 	}
 
+	//2025: a tickless one-shot may cover several quantums
+	ticks += kclock_ticks_per_interrupt() - 1;
+	//2025: wakeup the envs whose timed sleep is expired (by the tick counted below, since
+	//the lines below end by yielding the CPU)
+	timer_expire(ticks + 1);
+
 	/********DON'T CHANGE THESE LINES***********/
 	ticks++ ;
 	struct Env* p = get_cpu_proc();
@@ -451,6 +535,7 @@ void clock_interrupt_handler(struct Trapframe* tf)
 		}
 		//cprintf("\n***************\nClock Handler\n***************\n") ;
 		//fos_scheduler();
+		sched_trace(p, STRC_PREEMPT);
 		yield();
 	}
 	/*****************************************/
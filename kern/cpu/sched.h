@@ -28,6 +28,7 @@ struct
 	struct kspinlock qlock;				/*2024*///Lock to protect all queues
 	struct Env_Queue env_new_queue;		// queue of all new envs
 	struct Env_Queue env_exit_queue;	// queue of all exited envs
+	uint32 num_of_blocked;				// number of envs BLOCKED on channels (maintained by sleep & wakeup)
 #if USE_KHEAP
 	struct Env_Queue *env_ready_queues;	// Ready queue(s) for the MLFQ or RR
 #else
@@ -82,6 +83,8 @@ struct Env* fos_scheduler_PRIRR();
 //2012
 // This function does not return.
 void fos_scheduler(void) __attribute__((noreturn));
+void sched_idle(void);
+uint32 sched_next_event_in_quantums(void);
 
 void sched_init();
 void clock_interrupt_handler(struct Trapframe* tf);
@@ -9,6 +9,8 @@
 #include <kern/tests/utilities.h>
 #include <kern/cmd/command_prompt.h>
 #include <kern/cpu/cpu.h>
+#include <kern/cpu/kclock.h>
+#include <kern/cpu/sched_trace.h>
 
 //void on_clock_update_WS_time_stamps();
 extern void cleanup_buffers(struct Env* e);
@@ -156,6 +158,11 @@ void sched_insert_ready(struct Env* env)
 		//cprintf("\nInserting %d into ready queue 0\n", env->env_id);
 		env->env_status = ENV_READY ;
 		enqueue(&(ProcessQueues.env_ready_queues[env->priority]), env);
+		sched_trace(env, STRC_ENQUEUE);
+
+		//2025: the running env (if tickless) has now a competitor, restore the quantum
+		if (kclock_is_tickless())
+			kclock_exit_tickless();
 	}
 }
 
@@ -184,6 +191,105 @@ void sched_remove_ready(struct Env* env)
 	}
 }
 
+//=================================================
+// [3.1] Check if any env is in the Ready Queue(s):
+//=================================================
+int sched_any_ready()
+{
+	/*To protect process Qs (or info of current process) in multi-CPU*/
+	if(!holding_kspinlock(&ProcessQueues.qlock))
+		panic("sched: q.lock is not held by this CPU while it's expected to be.");
+	/*********************************************************************/
+
+	for (int i = 0 ; i < num_of_ready_queues ; i++)
+	{
+		if (!LIST_EMPTY(&(ProcessQueues.env_ready_queues[i])))
+			return 1;
+	}
+	return 0;
+}
+
+//=================================================
+// [3.2] Co-schedule the group of the dispatched Env:
+//=================================================
+//2025: the READY members of a group (created via sys_create_env_in_group) are
+//dispatched back-to-back (a "gang round") to reduce the stalls on their shared locks.
+//At the start of a round, the other READY members are moved to the dequeue end of their
+//ready queues (without changing their priority). A new round can't start till the
+//current one ends, so the group can't starve the other envs.
+static int32 gang_group_id = 0;		//group of the current gang round (0: none)
+static int gang_remaining = 0;		//num of members still to be dispatched in the round
+
+void sched_gang_dispatch(struct Env* env)
+{
+	/*To protect process Qs (or info of current process) in multi-CPU*/
+	if(!holding_kspinlock(&ProcessQueues.qlock))
+		panic("sched: q.lock is not held by this CPU while it's expected to be.");
+	/*********************************************************************/
+
+	if (env->group_id != 0 && env->group_id == gang_group_id && gang_remaining > 0)
+	{
+		gang_remaining--;
+		return;
+	}
+	gang_group_id = 0;
+	gang_remaining = 0;
+	if (env->group_id == 0)
+		return;
+
+	//Start a new gang round
+	gang_group_id = env->group_id;
+	for (int e = 0; e < NENV; e++)
+	{
+		struct Env* member = &envs[e];
+		if (member == env || member->group_id != gang_group_id || member->env_status != ENV_READY)
+			continue;
+		for (int i = 0 ; i < num_of_ready_queues ; i++)
+		{
+			if (find_env_in_queue(&(ProcessQueues.env_ready_queues[i]), member->env_id) != NULL)
+			{
+				LIST_REMOVE(&(ProcessQueues.env_ready_queues[i]), member);
+				LIST_INSERT_TAIL(&(ProcessQueues.env_ready_queues[i]), member);
+				gang_remaining++;
+				break;
+			}
+		}
+	}
+}
+
+//=================================================
+// [3.3] Boost the group of the given Env:
+//=================================================
+//2025: the members of a group inherit the priority boost of any of them together,
+//so a lock holder is not left behind its waiters in a lower priority
+void sched_boost_group(struct Env* env)
+{
+	/*To protect process Qs (or info of current process) in multi-CPU*/
+	if(!holding_kspinlock(&ProcessQueues.qlock))
+		panic("sched: q.lock is not held by this CPU while it's expected to be.");
+	/*********************************************************************/
+
+	if (env->group_id == 0)
+		return;
+	for (int e = 0; e < NENV; e++)
+	{
+		struct Env* member = &envs[e];
+		if (member == env || member->group_id != env->group_id || member->priority <= env->priority)
+			continue;
+		if (member->env_status == ENV_READY)
+		{
+			sched_remove_ready(member);
+			member->priority = env->priority;
+			member->waiting_time = 0;
+			sched_insert_ready(member);
+		}
+		else if (member->env_status == ENV_BLOCKED || member->env_status == ENV_NEW)
+		{
+			member->priority = env->priority;
+		}
+	}
+}
+
 //=================================================
 // [4] Insert the given Env in NEW Queue:
 //=================================================
@@ -709,6 +815,7 @@ void env_set_priority(int envID, int priority)
             release_kspinlock(&ProcessQueues.qlock);
         }
 
+        int is_boosted = (priority < e->priority);
         e->priority = priority;
         e->waiting_time=0;
         if (is_ready)
@@ -717,6 +824,13 @@ void env_set_priority(int envID, int priority)
             sched_insert_ready(e);
             release_kspinlock(&ProcessQueues.qlock);
         }
+        //2025: boost the other members of its group (if any) as well
+        if (is_boosted)
+        {
+            acquire_kspinlock(&ProcessQueues.qlock);
+            sched_boost_group(e);
+            release_kspinlock(&ProcessQueues.qlock);
+        }
         //Comment the following line
             //panic("env_set_priority() is not implemented yet...!!");
 //        if (priority < 0 || priority >= num_of_ready_queues)
@@ -24,6 +24,9 @@ void sched_set_starv_thresh(uint32 starvThresh);
 //void sched_insert_ready0(struct Env* env);
 void sched_insert_ready(struct Env* env);
 void sched_remove_ready(struct Env* env);
+int sched_any_ready();
+void sched_gang_dispatch(struct Env* env);
+void sched_boost_group(struct Env* env);
 void sched_insert_new(struct Env* env);
 void sched_remove_new(struct Env* env);
 void sched_insert_exit(struct Env* env);
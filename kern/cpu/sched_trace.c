@@ -0,0 +1,233 @@
+/*
+ * sched_trace.c
+ *
+ *	Each CPU writes its scheduler events in its own ring, so no lock is needed:
+ *	only the local interrupts are disabled while reserving & filling a slot.
+ *	The ring is overwritten circularly, so it always holds the latest STRC_RING_SIZE events.
+ *	The rings of all the CPUs are merged by the timestamps when they're printed (an env can
+ *	be enqueued by a CPU & dispatched by another one).
+ */
+
+#include "sched_trace.h"
+
+#include <inc/x86.h>
+#include <inc/stdio.h>
+#include <inc/string.h>
+#include <kern/cpu/cpu.h>
+#include <kern/cpu/sched.h>
+#include <kern/tests/utilities.h>
+
+static struct sched_trace_ring sched_traces[NCPUS];
+
+static inline struct sched_trace_ring* mytrace()
+{
+	return &sched_traces[mycpu() - CPUS];
+}
+
+//=====================================================
+// Record the given event of the given env in the ring of this CPU
+//=====================================================
+void sched_trace(struct Env* e, uint8 event)
+{
+	if (e == NULL)
+		return;
+	pushcli();
+	{
+		struct sched_trace_ring* ring = mytrace();
+		struct sched_trace_event* ev = &ring->events[ring->head & (STRC_RING_SIZE - 1)];
+		ring->head++;
+		ev->tsc = read_tsc();
+		ev->env_id = e->env_id;
+		ev->event = event;
+		ev->priority = e->priority < STRC_MAX_LEVELS ? e->priority : STRC_MAX_LEVELS - 1;
+	}
+	popcli();
+}
+
+void sched_trace_reset()
+{
+	pushcli();
+	{
+		for (int c = 0; c < NCPUS; c++)
+			sched_traces[c].head = 0;
+	}
+	popcli();
+}
+
+//=====================================================
+// Dump histograms of the traced events per priority level:
+//	1. wait latency: from ENQUEUE till DISPATCH (in cycles)
+//	2. quantum utilization: run length from DISPATCH till BLOCK relative
+//	   to the full quantum (avg run length of the runs ended by PREEMPT)
+//=====================================================
+//Per-env state while replaying the rings
+static uint64 last_enqueue[NENV];
+static uint64 last_dispatch[NENV];
+static uint32 lat_hist[STRC_MAX_LEVELS][STRC_LAT_BUCKETS];
+static uint32 util_hist[STRC_MAX_LEVELS][STRC_UTIL_BUCKETS + 1];
+static uint64 blocked_runs[NCPUS * STRC_RING_SIZE];
+static uint8 blocked_runs_pri[NCPUS * STRC_RING_SIZE];
+
+//Next event (by the timestamps) of the given rings (from the given positions till the given heads)
+//Returns NULL if all of them are replayed, otherwise advances the position of its ring
+static struct sched_trace_event* next_event(uint32 pos[], uint32 heads[])
+{
+	int c_min = -1;
+	for (int c = 0; c < NCPUS; c++)
+	{
+		if (pos[c] == heads[c])
+			continue;
+		if (c_min == -1 || sched_traces[c].events[pos[c] & (STRC_RING_SIZE - 1)].tsc <
+				sched_traces[c_min].events[pos[c_min] & (STRC_RING_SIZE - 1)].tsc)
+			c_min = c;
+	}
+	if (c_min == -1)
+		return NULL;
+	return &sched_traces[c_min].events[(pos[c_min]++) & (STRC_RING_SIZE - 1)];
+}
+
+static int lat_bucket(uint64 cycles)
+{
+	int b = 0;
+	cycles >>= STRC_LAT_SHIFT;
+	while (cycles > 1 && b < STRC_LAT_BUCKETS - 1)
+	{
+		cycles >>= 1;
+		b++;
+	}
+	return b;
+}
+
+static void print_bar(uint32 cnt, uint32 max)
+{
+	int len = max == 0 ? 0 : (cnt * 40 + max - 1) / max;
+	for (int i = 0; i < len; i++)
+		cprintf("#");
+	cprintf("\n");
+}
+
+void sched_trace_print()
+{
+	pushcli();
+
+	//the latest events of each ring (the other CPUs keep tracing, so their heads are taken
+	//once here: the events written after are not replayed)
+	uint32 pos[NCPUS], heads[NCPUS];
+	uint32 num_of_events = 0;
+	for (int c = 0; c < NCPUS; c++)
+	{
+		heads[c] = sched_traces[c].head;
+		uint32 n = heads[c] < STRC_RING_SIZE ? heads[c] : STRC_RING_SIZE;
+		pos[c] = heads[c] - n;
+		num_of_events += n;
+	}
+
+	memset(last_enqueue, 0, sizeof(last_enqueue));
+	memset(last_dispatch, 0, sizeof(last_dispatch));
+	memset(lat_hist, 0, sizeof(lat_hist));
+	memset(util_hist, 0, sizeof(util_hist));
+
+	//Replay the events of all the CPUs in order
+	uint64 preempt_cycles = 0;
+	uint32 num_of_preempts = 0, num_of_blocked_runs = 0;
+	uint32 cnt[STRC_WAKEUP + 1] = {0};
+	struct sched_trace_event* ev;
+	while ((ev = next_event(pos, heads)) != NULL)
+	{
+		uint32 x = ENVX(ev->env_id);
+		if (x >= NENV)
+			continue;
+		cnt[ev->event]++;
+		switch (ev->event)
+		{
+		case STRC_ENQUEUE:
+			last_enqueue[x] = ev->tsc;
+			break;
+		case STRC_DISPATCH:
+			if (last_enqueue[x] != 0)
+				lat_hist[ev->priority][lat_bucket(ev->tsc - last_enqueue[x])]++;
+			last_enqueue[x] = 0;
+			last_dispatch[x] = ev->tsc;
+			break;
+		case STRC_PREEMPT:
+			if (last_dispatch[x] != 0)
+			{
+				preempt_cycles += ev->tsc - last_dispatch[x];
+				num_of_preempts++;
+			}
+			last_dispatch[x] = 0;
+			break;
+		case STRC_BLOCK:
+			if (last_dispatch[x] != 0)
+			{
+				blocked_runs[num_of_blocked_runs] = ev->tsc - last_dispatch[x];
+				blocked_runs_pri[num_of_blocked_runs] = ev->priority;
+				num_of_blocked_runs++;
+			}
+			last_dispatch[x] = 0;
+			break;
+		}
+	}
+	//the full quantum (in cycles) is estimated by the avg run length of the preempted runs
+	//(shifted to avoid the 64-bit division)
+	uint32 quantum_cycles = 0;
+	if (num_of_preempts > 0)
+		quantum_cycles = (uint32)(preempt_cycles >> 8) / num_of_preempts;
+	for (int r = 0; r < num_of_blocked_runs; r++)
+	{
+		//runs longer than the quantum are counted in the last bucket
+		uint32 b = STRC_UTIL_BUCKETS;
+		if (quantum_cycles > 0)
+		{
+			uint32 run = (uint32)(blocked_runs[r] >> 8);
+			b = run >= quantum_cycles ? STRC_UTIL_BUCKETS : (run * STRC_UTIL_BUCKETS) / quantum_cycles;
+		}
+		util_hist[blocked_runs_pri[r]][b]++;
+	}
+
+	popcli();
+
+	cprintf("Scheduler trace: %d events (ENQUEUE = %d, DISPATCH = %d, PREEMPT = %d, BLOCK = %d, WAKEUP = %d)\n",
+			num_of_events, cnt[STRC_ENQUEUE], cnt[STRC_DISPATCH], cnt[STRC_PREEMPT], cnt[STRC_BLOCK], cnt[STRC_WAKEUP]);
+	if (num_of_preempts > 0)
+		cprintf("Estimated quantum = ~%d x 256 cycles\n", quantum_cycles);
+
+	for (int p = 0; p < STRC_MAX_LEVELS; p++)
+	{
+		uint32 max = 0, total = 0;
+		for (int b = 0; b < STRC_LAT_BUCKETS; b++)
+		{
+			total += lat_hist[p][b];
+			if (lat_hist[p][b] > max) max = lat_hist[p][b];
+		}
+		uint32 max_util = 0, total_util = 0;
+		for (int b = 0; b <= STRC_UTIL_BUCKETS; b++)
+		{
+			total_util += util_hist[p][b];
+			if (util_hist[p][b] > max_util) max_util = util_hist[p][b];
+		}
+		if (total == 0 && total_util == 0)
+			continue;
+
+		cprintf("\n===== Priority %d =====\n", p);
+		cprintf("Wait latency (cycles):\n");
+		for (int b = 0; b < STRC_LAT_BUCKETS; b++)
+		{
+			if (lat_hist[p][b] == 0)
+				continue;
+			cprintf("  < 2^%d\t: %d\t", b + STRC_LAT_SHIFT + 1, lat_hist[p][b]);
+			print_bar(lat_hist[p][b], max);
+		}
+		cprintf("Quantum utilization before blocking:\n");
+		for (int b = 0; b <= STRC_UTIL_BUCKETS; b++)
+		{
+			if (util_hist[p][b] == 0)
+				continue;
+			if (b == STRC_UTIL_BUCKETS)
+				cprintf("  >= 100%%\t: %d\t", util_hist[p][b]);
+			else
+				cprintf("  %d-%d%%\t: %d\t", b * 10, (b + 1) * 10, util_hist[p][b]);
+			print_bar(util_hist[p][b], max_util);
+		}
+	}
+}
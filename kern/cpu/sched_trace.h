@@ -0,0 +1,47 @@
+/*
+ * sched_trace.h
+ *
+ *	Per-CPU trace ring of the scheduler events (used by the "schedtrace" command)
+ */
+
+#ifndef FOS_KERN_SCHED_TRACE_H
+#define FOS_KERN_SCHED_TRACE_H
+#ifndef FOS_KERNEL
+# error "This is a FOS kernel header; user programs should not #include it"
+#endif
+
+#include <inc/types.h>
+#include <inc/environment_definitions.h>
+
+//Trace events
+#define STRC_ENQUEUE	0	/* inserted in a ready queue */
+#define STRC_DISPATCH	1	/* picked by the scheduler to run */
+#define STRC_PREEMPT	2	/* its quantum is expired */
+#define STRC_BLOCK		3	/* blocked on a channel */
+#define STRC_WAKEUP		4	/* woken up from a channel (or a timed sleep) */
+
+#define STRC_RING_SIZE		1024	/* MUST be power of 2 */
+#define STRC_MAX_LEVELS		8		/* priorities beyond are counted in the last level */
+#define STRC_LAT_BUCKETS	24		/* latency buckets: [2^(i+STRC_LAT_SHIFT), 2^(i+STRC_LAT_SHIFT+1)) cycles */
+#define STRC_LAT_SHIFT		8
+#define STRC_UTIL_BUCKETS	10		/* utilization buckets: [10*i %, 10*(i+1) %) of the quantum */
+
+struct sched_trace_event
+{
+	uint64 tsc;			//timestamp (via rdtsc)
+	int32 env_id;
+	uint8 event;		//STRC_xxx
+	uint8 priority;		//priority (ready queue level) of the env at the event
+};
+
+struct sched_trace_ring
+{
+	struct sched_trace_event events[STRC_RING_SIZE];
+	uint32 head;		//total num of events written so far (next slot = head % STRC_RING_SIZE)
+};
+
+void sched_trace(struct Env* e, uint8 event);
+void sched_trace_reset();
+void sched_trace_print();
+
+#endif	// !FOS_KERN_SCHED_TRACE_H
@@ -0,0 +1,195 @@
+/*
+ * timer_wheel.c
+ *
+ *	Hierarchical timer wheel (TW_LEVELS levels of TW_SIZE slots each):
+ *	a timer that expires after d ticks is placed in level 0 if d < TW_SIZE,
+ *	in level 1 if d < TW_SIZE^2, ... Each time the level-0 index wraps around,
+ *	the timers of the current slot in the upper level are cascaded down.
+ *	So, adding, cancelling & expiring a timer are all O(1).
+ *
+ *	All the wheel (and the envs it wakes up) is protected by the ProcessQueues.qlock
+ */
+
+#include "timer_wheel.h"
+
+#include <inc/assert.h>
+#include <kern/cpu/sched.h>
+#include <kern/cpu/kclock.h>
+#include <kern/cpu/sched_trace.h>
+#include <kern/conc/channel.h>
+#include <kern/proc/user_environment.h>
+
+static struct Timer_List wheel[TW_LEVELS][TW_SIZE];
+static int64 tw_now ;			//last tick processed by the wheel
+static uint32 tw_count ;		//num of timers in the wheel
+
+//channel & lock of the envs that sleep without waiting for any event (i.e. sys_sleep)
+static struct Channel sleep_chan ;
+static struct kspinlock sleep_lk ;
+
+void timer_wheel_init()
+{
+	for (int l = 0; l < TW_LEVELS; l++)
+		for (int s = 0; s < TW_SIZE; s++)
+			LIST_INIT(&wheel[l][s]);
+	tw_now = ticks;
+	tw_count = 0;
+	init_channel(&sleep_chan, "sleep channel");
+	init_kspinlock(&sleep_lk, "sleep lock");
+}
+
+//Place the timer in the slot corresponding to its remaining ticks
+static void tw_insert(struct Timer* t)
+{
+	uint32 delta = (uint32)(t->expiry - tw_now);
+	int level = 0;
+	while (level < TW_LEVELS - 1 && delta >= (1 << (TW_BITS * (level + 1))))
+		level++;
+
+	t->slot = &wheel[level][(t->expiry >> (TW_BITS * level)) & TW_MASK];
+	LIST_INSERT_HEAD(t->slot, t);
+	t->in_wheel = 1;
+	tw_count++;
+}
+
+static void tw_remove(struct Timer* t)
+{
+	LIST_REMOVE(t->slot, t);
+	t->in_wheel = 0;
+	tw_count--;
+}
+
+//Move the timers of the current slot at the given level to the lower level(s)
+static void tw_cascade(int level)
+{
+	struct Timer_List* slot = &wheel[level][(tw_now >> (TW_BITS * level)) & TW_MASK];
+	struct Timer* t;
+	while ((t = LIST_FIRST(slot)) != NULL)
+	{
+		tw_remove(t);
+		tw_insert(t);
+	}
+}
+
+//Wakeup the env of the given expired timer (if it's not already woken up by its channel)
+static void tw_fire(struct Timer* t)
+{
+	struct Env* e = t->env;
+	if (e->env_status != ENV_BLOCKED)
+		return;
+	t->expired = 1;
+	remove_from_queue(&(t->chan->queue), e);
+	ProcessQueues.num_of_blocked--;
+	sched_trace(e, STRC_WAKEUP);
+	sched_insert_ready(e);
+}
+
+//=====================================================
+// Add a timer for the given (blocked) env on the given channel
+// to expire after the given num of ticks. The qlock MUST be held
+//=====================================================
+void timer_add(struct Timer* t, struct Env* env, struct Channel* chan, uint32 num_of_ticks)
+{
+	if(!holding_kspinlock(&ProcessQueues.qlock))
+		panic("timer_add: q.lock is not held by this CPU while it's expected to be.");
+
+	if (num_of_ticks == 0)
+		num_of_ticks = 1;
+	if (num_of_ticks > TW_MAX_TICKS)
+		num_of_ticks = TW_MAX_TICKS;
+
+	t->env = env;
+	t->chan = chan;
+	t->expired = 0;
+	t->expiry = tw_now + num_of_ticks;
+	tw_insert(t);
+}
+
+//=====================================================
+// Remove the given timer from the wheel before its expiry. The qlock MUST be held
+//=====================================================
+void timer_cancel(struct Timer* t)
+{
+	if(!holding_kspinlock(&ProcessQueues.qlock))
+		panic("timer_cancel: q.lock is not held by this CPU while it's expected to be.");
+
+	if (t->in_wheel)
+		tw_remove(t);
+}
+
+//=====================================================
+// Advance the wheel till the given tick & wakeup the envs of the expired timers
+// (called by the clock interrupt handler)
+//=====================================================
+void timer_expire(int64 now)
+{
+	acquire_kspinlock(&ProcessQueues.qlock);
+	{
+		if (tw_count == 0)
+		{
+			tw_now = now;
+		}
+		while (tw_now < now)
+		{
+			tw_now++;
+			if ((tw_now & TW_MASK) == 0)
+			{
+				for (int l = TW_LEVELS - 1; l > 0; l--)
+				{
+					//cascade a level only if all the levels below it are wrapped around
+					if ((tw_now & ((1 << (TW_BITS * l)) - 1)) == 0)
+						tw_cascade(l);
+				}
+			}
+			struct Timer_List* slot = &wheel[0][tw_now & TW_MASK];
+			struct Timer* t;
+			while ((t = LIST_FIRST(slot)) != NULL)
+			{
+				tw_remove(t);
+				tw_fire(t);
+			}
+		}
+	}
+	release_kspinlock(&ProcessQueues.qlock);
+}
+
+//=====================================================
+// Num of ticks till the next slot to be processed (0 if no timers)
+// The caller should hold the qlock (or disable the interrupts)
+//=====================================================
+uint32 timer_next_expiry()
+{
+	if (tw_count == 0)
+		return 0;
+	for (uint32 d = 1; d <= TW_SIZE; d++)
+	{
+		uint32 idx = (tw_now + d) & TW_MASK;
+		//non-empty slot or a cascade from the upper levels
+		if (idx == 0 || !LIST_EMPTY(&wheel[0][idx]))
+			return d;
+	}
+	return TW_SIZE;
+}
+
+//Convert the given milliseconds to num of clock ticks (rounded up)
+uint32 timer_ms_to_ticks(uint32 milliseconds)
+{
+	uint32 quantum = kclock_get_quantum();
+	if (quantum == 0)
+		quantum = 1;
+	return (milliseconds + quantum - 1) / quantum;
+}
+
+//=====================================================
+// Block the current env for (at least) the given milliseconds
+//=====================================================
+void timer_sleep(uint32 milliseconds)
+{
+	if (milliseconds == 0)
+		return;
+	acquire_kspinlock(&sleep_lk);
+	{
+		sleep_timeout(&sleep_chan, &sleep_lk, milliseconds);
+	}
+	release_kspinlock(&sleep_lk);
+}
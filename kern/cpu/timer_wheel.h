@@ -0,0 +1,46 @@
+/*
+ * timer_wheel.h
+ *
+ *	Hierarchical timer wheel to hold the timed sleeps of the envs.
+ *	It's driven by the clock interrupt (1 tick = 1 quantum)
+ */
+
+#ifndef FOS_KERN_TIMER_WHEEL_H
+#define FOS_KERN_TIMER_WHEEL_H
+#ifndef FOS_KERNEL
+# error "This is a FOS kernel header; user programs should not #include it"
+#endif
+
+#include <inc/types.h>
+#include <inc/queue.h>
+#include <inc/environment_definitions.h>
+
+#define TW_BITS			6
+#define TW_SIZE			(1 << TW_BITS)					/* num of slots per level */
+#define TW_MASK			(TW_SIZE - 1)
+#define TW_LEVELS		3								/* level i: each slot covers TW_SIZE^i ticks */
+#define TW_MAX_TICKS	((1 << (TW_BITS * TW_LEVELS)) - 1)	/* max timeout (longer ones are clamped) */
+
+struct Channel;
+
+struct Timer
+{
+	int64 expiry;					//tick at which the timer expires
+	struct Env* env;				//env that's blocked till the expiry (or till a wakeup on its channel)
+	struct Channel* chan;			//channel that the env is blocked on
+	uint8 in_wheel;					//1 if it's still linked in one of the wheel slots
+	uint8 expired;					//1 if the env is woken up by this timer
+	struct Timer_List* slot;		//slot that holds the timer (if in_wheel)
+	LIST_ENTRY(Timer) prev_next_info;
+};
+LIST_HEAD(Timer_List, Timer);
+
+void timer_wheel_init();
+void timer_add(struct Timer* t, struct Env* env, struct Channel* chan, uint32 num_of_ticks);
+void timer_cancel(struct Timer* t);
+void timer_expire(int64 now);
+uint32 timer_next_expiry();
+uint32 timer_ms_to_ticks(uint32 milliseconds);
+void timer_sleep(uint32 milliseconds);
+
+#endif	// !FOS_KERN_TIMER_WHEEL_H
@@ -0,0 +1,180 @@
+/*
+ * Block request queue in front of the IDE driver
+ *
+ * The page-file reads/writes of all envs are submitted to a single queue that's
+ * kept sorted by sector. The requests are served by a C-LOOK elevator (ascending
+ * sectors from the current head position, then wrap to the lowest one), unless the
+ * oldest one exceeded its deadline, and each command merges the requests that are
+ * adjacent on the disk with the same direction (by a vectored ide_readv/ide_writev).
+ *
+ * There're no kernel threads, so the requests are served by the submitters: the
+ * first env that waits while the disk is idle becomes the dispatcher and serves
+ * requests (its own & the others') till its own is done, then hands the role off
+ * to the owner of a pending one. The others sleep on their requests till done.
+ */
+
+#include "disk_queue.h"
+#include <inc/error.h>
+#include <inc/assert.h>
+#include <kern/cpu/sched.h>
+#include <kern/cpu/timer_wheel.h>
+#include <kern/proc/user_environment.h>
+#include "../mem/memory_manager.h"
+
+void disk_queue_init()
+{
+	init_kspinlock(&DiskQueue.lock, "Disk Queue Lock");
+	LIST_INIT(&DiskQueue.pending);
+	DiskQueue.head_pos = 0;
+	DiskQueue.dispatching = 0;
+	DiskQueue.num_of_requests = DiskQueue.num_of_commands = DiskQueue.num_of_deadline_misses = 0;
+}
+
+//Submit the request (it's NOT served till someone waits for it)
+void disk_submit(struct disk_request *req, uint32 secno, void *va, uint32 nsecs, bool isWrite)
+{
+	assert(nsecs > 0 && nsecs <= DISK_MAX_MERGE_SECS);
+	req->secno = secno;
+	req->nsecs = nsecs;
+	req->va = va;
+	req->isWrite = isWrite;
+	req->done = 0;
+	req->result = 0;
+	init_channel(&req->waitq, "disk request");
+
+	acquire_kspinlock(&DiskQueue.lock);
+	{
+		req->deadline = timer_ticks() + timer_ms_to_ticks(DISK_DEADLINE_MS);
+		//insert sorted by sector (after the ones of the same sector: FIFO among them)
+		struct disk_request *r = LIST_LAST(&DiskQueue.pending);
+		while (r != NULL && r->secno > secno)
+			r = LIST_PREV(r);
+		if (r == NULL)
+			LIST_INSERT_HEAD(&DiskQueue.pending, req);
+		else
+			LIST_INSERT_AFTER(&DiskQueue.pending, r, req);
+		DiskQueue.num_of_requests++;
+	}
+	release_kspinlock(&DiskQueue.lock);
+}
+
+//Pick the next request to serve: the expired one (if any), else by C-LOOK
+//The queue lock MUST be held & the queue MUST NOT be empty
+static struct disk_request* disk_pick_next()
+{
+	struct disk_request *r, *first_after_head = NULL, *expired = NULL;
+	int64 now = timer_ticks();
+	LIST_FOREACH(r, &DiskQueue.pending)
+	{
+		if (r->deadline <= now && (expired == NULL || r->deadline < expired->deadline))
+			expired = r;
+		if (first_after_head == NULL && r->secno >= DiskQueue.head_pos)
+			first_after_head = r;
+	}
+	if (expired != NULL)
+	{
+		DiskQueue.num_of_deadline_misses++;
+		return expired;
+	}
+	//C-LOOK: nothing after the head, wrap to the lowest sector
+	return first_after_head != NULL ? first_after_head : LIST_FIRST(&DiskQueue.pending);
+}
+
+//Serve one command: the picked request merged with the following adjacent ones
+//The queue lock MUST be held (it's released during the I/O)
+static void disk_dispatch_one()
+{
+	struct disk_request *batch[DISK_MAX_MERGE_REQS];
+	struct ide_segment segs[DISK_MAX_MERGE_REQS];
+	struct disk_request *r = disk_pick_next();
+	uint32 n = 0, nsecs = 0;
+	while (1)
+	{
+		struct disk_request *next = LIST_NEXT(r);
+		LIST_REMOVE(&DiskQueue.pending, r);
+		batch[n] = r;
+		segs[n].va = r->va;
+		segs[n].nsecs = r->nsecs;
+		nsecs += r->nsecs;
+		n++;
+		if (next == NULL || n == DISK_MAX_MERGE_REQS || next->isWrite != r->isWrite ||
+				next->secno != r->secno + r->nsecs || nsecs + next->nsecs > DISK_MAX_MERGE_SECS)
+			break;
+		r = next;
+	}
+	DiskQueue.head_pos = batch[n-1]->secno + batch[n-1]->nsecs;
+	DiskQueue.num_of_commands++;
+	release_kspinlock(&DiskQueue.lock);
+
+	int ret = batch[0]->isWrite ? ide_writev(batch[0]->secno, segs, n) : ide_readv(batch[0]->secno, segs, n);
+	for (uint32 i = 0; i < n; i++)
+	{
+		batch[i]->result = ret;
+		if (batch[i]->callback != NULL)
+			batch[i]->callback(batch[i]);
+	}
+
+	acquire_kspinlock(&DiskQueue.lock);
+	for (uint32 i = 0; i < n; i++)
+	{
+		batch[i]->done = 1;
+		wakeup_all(&batch[i]->waitq);
+	}
+}
+
+//Wait till the given (submitted) request is done, serving the queue meanwhile if the disk is idle
+//Returns the result of its read/write
+int disk_wait(struct disk_request *req)
+{
+	acquire_kspinlock(&DiskQueue.lock);
+	while (!req->done)
+	{
+		if (!DiskQueue.dispatching)
+		{
+			DiskQueue.dispatching = 1;
+			while (!req->done && LIST_FIRST(&DiskQueue.pending) != NULL)
+				disk_dispatch_one();
+			DiskQueue.dispatching = 0;
+			//hand the role off to the owner of a pending request (if any)
+			if (LIST_FIRST(&DiskQueue.pending) != NULL)
+				wakeup_all(&LIST_FIRST(&DiskQueue.pending)->waitq);
+		}
+		else
+			sleep(&req->waitq, &DiskQueue.lock);
+	}
+	release_kspinlock(&DiskQueue.lock);
+	return req->result;
+}
+
+//Translate the given VA of the current address space to the kernel VA of the same byte
+//(valid in all address spaces) or NULL if it's not mapped
+static void* disk_kernel_va(void *va)
+{
+	uint32 *ptr_page_table = NULL;
+	uint32 *ptr_page_directory = STATIC_KERNEL_VIRTUAL_ADDRESS(rcr3());
+	struct FrameInfo *ptr_frame_info = get_frame_info(ptr_page_directory, (uint32)va, &ptr_page_table);
+	if (ptr_frame_info == NULL)
+		return NULL;
+	return STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(ptr_frame_info) + PGOFF(va));
+}
+
+//Read/write consecutive sectors through the queue (blocks till done)
+int disk_queue_rw(uint32 secno, void *va, uint32 nsecs, bool isWrite)
+{
+	void *kva = disk_kernel_va(va);
+	//no env to block (e.g. kernel in command prompt), or a buffer that crosses a page
+	//(its frames may not be contiguous): direct (synchronous) read/write
+	if (get_cpu_proc() == NULL || kva == NULL || PGOFF(va) + nsecs * SECTSIZE > PAGE_SIZE)
+		return isWrite ? ide_write(secno, va, nsecs) : ide_read(secno, va, nsecs);
+
+	struct disk_request req;
+	req.callback = NULL;
+	disk_submit(&req, secno, kva, nsecs, isWrite);
+	return disk_wait(&req);
+}
+
+void disk_queue_print_stats()
+{
+	cprintf("Disk queue: %d requests served by %d commands (%d served by deadline)\n",
+			DiskQueue.num_of_requests, DiskQueue.num_of_commands, DiskQueue.num_of_deadline_misses);
+}
@@ -0,0 +1,52 @@
+#ifndef FOS_KERN_DISK_QUEUE_H
+#define FOS_KERN_DISK_QUEUE_H
+
+#ifndef FOS_KERNEL
+# error "This is a FOS kernel header; user programs should not #include it"
+#endif
+
+#include <inc/types.h>
+#include <inc/queue.h>
+#include <inc/disk.h>
+#include "../conc/kspinlock.h"
+#include "../conc/channel.h"
+
+#define DISK_DEADLINE_MS		100		//a request that waits more than it is served first (no starvation by the elevator)
+#define DISK_MAX_MERGE_SECS		256		//max num of sectors of one (merged) command
+#define DISK_MAX_MERGE_REQS		32		//max num of requests merged into one command
+
+//A request to read/write consecutive sectors from/to a buffer
+struct disk_request
+{
+	uint32 secno;
+	uint32 nsecs;
+	void *va;							//buffer (a KERNEL VA, so any env can serve the request)
+	uint8 isWrite;
+	volatile uint8 done;
+	int result;
+	int64 deadline;						//in timer ticks
+	void (*callback)(struct disk_request *req);	//(optional) called on completion
+	struct Channel waitq;				//the submitter waits on it
+	LIST_ENTRY(disk_request) prev_next_info;
+};
+LIST_HEAD(disk_request_list, disk_request);
+
+struct
+{
+	struct kspinlock lock;
+	struct disk_request_list pending;	//sorted by sector
+	uint32 head_pos;					//sector after the last served one (position of the disk head)
+	uint8 dispatching;					//an env is now serving the requests
+	//stats
+	uint32 num_of_requests;
+	uint32 num_of_commands;				//(< num_of_requests if merged)
+	uint32 num_of_deadline_misses;
+} DiskQueue;
+
+void disk_queue_init();
+void disk_submit(struct disk_request *req, uint32 secno, void *va, uint32 nsecs, bool isWrite);
+int disk_wait(struct disk_request *req);
+int disk_queue_rw(uint32 secno, void *va, uint32 nsecs, bool isWrite);
+void disk_queue_print_stats();
+
+#endif /* FOS_KERN_DISK_QUEUE_H */
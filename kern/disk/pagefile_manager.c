@@ -15,6 +15,9 @@
 
 #include "../mem/kheap.h"
 #include "../mem/memory_manager.h"
+#include "disk_queue.h"
+#include "pf_cache.h"
+#include "zswap.h"
 
 int __pf_write_env_table( struct Env* ptr_env, uint32 virtual_address, uint32* tableKVirtualAddress);
 int __pf_read_env_table(struct Env* ptr_env, uint32 virtual_address, uint32* tableKVirtualAddress);
@@ -22,25 +25,27 @@ void __pf_remove_env_all_tables(struct Env* ptr_env);
 void __pf_remove_env_table(struct Env* ptr_env, uint32 virtual_address);
 
 
-int read_disk_page(uint32 dfn, void* va)
+//Read/write the page directly from/to the disk (used by the page file cache on miss/eviction)
+int __read_disk_page(uint32 dfn, void* va)
 {
 	uint32 df_start_sector = PAGE_FILE_START_SECTOR+dfn*SECTOR_PER_PAGE;
 
 	//LOG_STATMENT( cprintf("reading from disk to mem addr %x at sector %d\n",va,df_start_sector);  );
-	int success = ide_read(df_start_sector, (void*)va, SECTOR_PER_PAGE);
+	//through the disk queue (sorted & merged with the requests of the other envs)
+	int success = disk_queue_rw(df_start_sector, (void*)va, SECTOR_PER_PAGE, 0);
 	//LOG_STATMENT( if(success==0) {cprintf("read from disk successuflly.\n");} else {cprintf("read from disk failed !!\n");} );
 
 	return success;
 }
 
 
-int write_disk_page(uint32 dfn, void* va)
+int __write_disk_page(uint32 dfn, void* va)
 {
 	//write disk at wanted frame
 	uint32 df_start_sector = PAGE_FILE_START_SECTOR+dfn*SECTOR_PER_PAGE;
 
 	//LOG_STATMENT( cprintf(">>> writing to disk from mem addr %x at sector %d\n",va,df_start_sector);  );
-	int success = ide_write(df_start_sector, (void*)va, SECTOR_PER_PAGE);
+	int success = disk_queue_rw(df_start_sector, (void*)va, SECTOR_PER_PAGE, 1);
 	//LOG_STATMENT( if(success==0) {cprintf(">>> written to disk successfully.\n");} else {cprintf(">>> written to disk failed !!\n");} );
 
 	if(success != 0)
@@ -48,6 +53,49 @@ int write_disk_page(uint32 dfn, void* va)
 	return success;
 }
 
+int read_disk_page(uint32 dfn, void* va)
+{
+#if PF_CACHE_ENABLED
+	return pf_cache_read(dfn, va);
+#else
+	return __read_disk_page(dfn, va);
+#endif
+}
+
+int write_disk_page(uint32 dfn, void* va)
+{
+#if PF_CACHE_ENABLED
+	return pf_cache_write(dfn, va);
+#else
+	return __write_disk_page(dfn, va);
+#endif
+}
+
+//2025: the env pages go to/come from the compressed pool first (if they fit there), then the disk
+static int write_env_disk_page(struct Env* ptr_env, uint32 dfn, void* va)
+{
+#if ZSWAP_ENABLED
+	if (zswap_store(ptr_env, dfn, va) == 0)
+	{
+#if PF_CACHE_ENABLED
+		//the older copy in the cache (if any) is stale now
+		pf_cache_invalidate(dfn);
+#endif
+		return 0;
+	}
+#endif
+	return write_disk_page(dfn, va);
+}
+
+static int read_env_disk_page(uint32 dfn, void* va)
+{
+#if ZSWAP_ENABLED
+	if (zswap_load(dfn, va) == 0)
+		return 0;
+#endif
+	return read_disk_page(dfn, va);
+}
+
 ///========================== PAGE FILE MANAGMENT ==============================
 
 uint32* ptr_disk_page_directory;
@@ -87,6 +135,12 @@ void initialize_disk_page_file()
 	}
 
 	init_kspinlock(&DiskFrameLists.dfllock, "Disk FrameList Lock");
+#if PF_CACHE_ENABLED
+	pf_cache_init();
+#endif
+#if ZSWAP_ENABLED
+	zswap_init();
+#endif
 }
 
 //
@@ -139,6 +193,13 @@ inline void free_disk_frame(uint32 dfn)
 {
 	// Fill this function in
 	if(dfn == 0) return;
+#if PF_CACHE_ENABLED
+	//its content is no longer needed: don't write it back
+	pf_cache_invalidate(dfn);
+#endif
+#if ZSWAP_ENABLED
+	zswap_invalidate(dfn);
+#endif
 	acquire_kspinlock(&DiskFrameLists.dfllock);
 	{
 		LIST_INSERT_HEAD(&DiskFrameLists.disk_free_frame_list, &disk_frames_info[dfn]);
@@ -150,14 +211,8 @@ int get_disk_page_table(uint32 *ptr_disk_page_directory, const uint32 virtual_ad
 {
 	// Fill this function in
 	uint32 disk_page_directory_entry = ptr_disk_page_directory[PDX(virtual_address)];
-	if(USE_KHEAP && !CHECK_IF_KERNEL_ADDRESS(virtual_address))
-	{
-		*ptr_disk_page_table = (uint32*)kheap_virtual_address(EXTRACT_ADDRESS(disk_page_directory_entry));
-	}
-	else
-	{
-		*ptr_disk_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(disk_page_directory_entry)) ;
-	}
+	//2025: the disk page tables are frames of the page tables pool (even with the KHEAP)
+	*ptr_disk_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(disk_page_directory_entry)) ;
 
 	if (disk_page_directory_entry == 0)
 	{
@@ -165,32 +220,16 @@ int get_disk_page_table(uint32 *ptr_disk_page_directory, const uint32 virtual_ad
 		//LOG_STATMENT(cprintf("get_disk_page_table: page table not found "));
 		if (create)
 		{
-
-#if USE_KHEAP
-			{
-				*ptr_disk_page_table = (uint32*)kmalloc(PAGE_SIZE);
-				if(*ptr_disk_page_table == NULL)
-				{
-					return E_NO_VM;
-				}
-				ptr_disk_page_directory[PDX(virtual_address)] = CONSTRUCT_ENTRY(
-						kheap_physical_address((unsigned int)*ptr_disk_page_table)
-						,PERM_PRESENT);
-			}
-#else
 			{
+				//(2025: a zeroed frame of the page tables pool, no need to initialize it, its references = 1)
 				struct FrameInfo* ptr_frame_info;
-				allocate_frame(&ptr_frame_info) ;
+				allocate_page_table_frame(&ptr_frame_info) ;
 
 				//LOG_STATMENT(cprintf("created table"));
 				uint32 phys_page_table = to_physical_address(ptr_frame_info);
 				*ptr_disk_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(phys_page_table) ;
-				ptr_frame_info->references = 1;
 				ptr_disk_page_directory[PDX(virtual_address)] = CONSTRUCT_ENTRY(phys_page_table,PERM_PRESENT);
 			}
-#endif
-			//initialize new page table by 0's
-			memset(*ptr_disk_page_table , 0, PAGE_SIZE);
 
 			//LOG_STATMENT(cprintf("get_disk_page_table: disk directory entry # %d (VA = %x) is %x ",PDX(virtual_address),
 			//virtual_address, ptr_disk_page_directory[PDX(virtual_address)]));
@@ -374,7 +413,7 @@ int pf_update_env_page(struct Env* ptr_env, uint32 virtual_address, struct Frame
 			ptrTable[PTX(virtual_address)] |= PERM_PRESENT ;
 		}
 		//3. Write the disk page
-		ret = write_disk_page(dfn, (void*)ROUNDDOWN(virtual_address, PAGE_SIZE));
+		ret = write_env_disk_page(ptr_env, dfn, (void*)ROUNDDOWN(virtual_address, PAGE_SIZE));
 		//4. Restore the original permissions
 		ptrTable[PTX(virtual_address)] &= 0xFFFFF000 ;
 		ptrTable[PTX(virtual_address)] |= origPerms ;
@@ -385,7 +424,7 @@ int pf_update_env_page(struct Env* ptr_env, uint32 virtual_address, struct Frame
 	}
 #else
 	{
-		ret = write_disk_page(dfn, STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(modified_page_frame_info)));
+		ret = write_env_disk_page(ptr_env, dfn, STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(modified_page_frame_info)));
 		//cprintf("[%s] finished updating page\n",ptr_env->prog_name);
 	}
 #endif
@@ -429,7 +468,7 @@ int pf_read_env_page(struct Env* ptr_env, void* virtual_address)
 
 	if( dfn == 0) return E_PAGE_NOT_EXIST_IN_PF;
 
-	int disk_read_error = read_disk_page(dfn, virtual_address);
+	int disk_read_error = read_env_disk_page(dfn, virtual_address);
 
 	//reset modified bit to 0: because FOS copies the placed or replaced page from
 	//HD to memory, the page modified bit is set to 1, but we want the modified bit to be
@@ -443,6 +482,16 @@ int pf_read_env_page(struct Env* ptr_env, void* virtual_address)
 	return disk_read_error;
 }
 
+//2025: is the given page of the env in the page file?
+bool pf_is_env_page_exist(struct Env* ptr_env, uint32 virtual_address)
+{
+	uint32 *ptr_disk_page_table;
+	if (ptr_env->disk_env_pgdir == 0)
+		return 0;
+	get_disk_page_table(ptr_env->disk_env_pgdir, virtual_address, 0, &ptr_disk_page_table);
+	return ptr_disk_page_table != NULL && ptr_disk_page_table[PTX(virtual_address)] != 0;
+}
+
 void pf_remove_env_page(struct Env* ptr_env, uint32 virtual_address)
 {
 	//LOG_STRING("pf_remove_env_page: 0");
@@ -474,16 +523,7 @@ void pf_free_env(struct Env* ptr_env)
 
 		// find the pa and va of the page table
 		uint32 pa = EXTRACT_ADDRESS(ptr_env->disk_env_pgdir[pdeno]);
-		uint32 *pt;
-#if USE_KHEAP
-		{
-			pt = (uint32*) kheap_virtual_address(pa);
-		}
-#else
-		{
-			pt = (uint32*) STATIC_KERNEL_VIRTUAL_ADDRESS(pa);
-		}
-#endif
+		uint32 *pt = (uint32*) STATIC_KERNEL_VIRTUAL_ADDRESS(pa);
 		// unmap all PTEs in this page table
 		uint32 pteno;
 		for (pteno = 0; pteno < 1024; pteno++)
@@ -495,17 +535,11 @@ void pf_free_env(struct Env* ptr_env)
 			free_disk_frame(dfn);
 		}
 
-		// free the disk page table itself
+		// free the disk page table itself (2025: back to the page tables pool)
 		ptr_env->disk_env_pgdir[pdeno] = 0;
-#if USE_KHEAP
-		{
-			kfree(pt);
-		}
-#else
-		{
-			decrement_references(to_frame_info(pa));
-		}
-#endif
+		struct FrameInfo *ptr_table_frame = to_frame_info(pa);
+		if (--(ptr_table_frame->references) == 0)
+			free_page_table_frame(ptr_table_frame);
 	}
 
 	// free the disk page directory of the environment
@@ -595,15 +629,7 @@ int pf_calculate_allocated_pages(struct Env* ptr_env)
 
 		// find the pa and va of the page table
 		pa = EXTRACT_ADDRESS(ptr_env->disk_env_pgdir[pdIndex]);
-#if USE_KHEAP
-		{
-			pt = (uint32*) kheap_virtual_address(pa);
-		}
-#else
-		{
-			pt = (uint32*) STATIC_KERNEL_VIRTUAL_ADDRESS(pa);
-		}
-#endif
+		pt = (uint32*) STATIC_KERNEL_VIRTUAL_ADDRESS(pa);
 
 		// count existing PTEs in this page table
 		uint32 ptIndex;
@@ -30,6 +30,7 @@ int pf_add_env_page( struct Env* ptr_env, uint32 virtual_address, void* dataSrc)
 int pf_update_env_page(struct Env* ptr_env, uint32 virtual_address, struct FrameInfo* modified_page_frame_info);
 //int pf_special_update_env_modified_page(struct Env* ptr_env, uint32 virtual_address, struct Frame_Info* page_modified_frame_info);
 int pf_read_env_page(struct Env* ptr_env, void* virtual_address);
+bool pf_is_env_page_exist(struct Env* ptr_env, uint32 virtual_address);
 void pf_remove_env_page(struct Env* ptr_env, uint32 virtual_address);
 ///=============================================================================================
 
@@ -0,0 +1,234 @@
+/*
+ * Page-file block cache
+ *
+ * Keeps the recently read/written pages of the page file (env pages & tables) in
+ * PF_CACHE_NUM_BLOCKS frames, found by a hash on the disk frame number. It's
+ * write-back: a write only updates the cached copy & marks it dirty, and the page
+ * goes to the disk when it's evicted (LRU). So a page that's evicted from the
+ * memory then faulted again soon, or a table that's written then read again,
+ * doesn't touch the disk at all.
+ * The cache lock is NOT held during the disk I/O (of a miss or a write-back), so
+ * the page file requests of several envs reach the disk queue together: the block
+ * is marked busy instead, and the other users of that block wait till it's done.
+ */
+
+#include "pf_cache.h"
+#include <inc/string.h>
+#include <inc/assert.h>
+#include <kern/proc/user_environment.h>
+#include "../mem/memory_manager.h"
+
+extern int __read_disk_page(uint32 dfn, void* va);
+extern int __write_disk_page(uint32 dfn, void* va);
+
+static inline uint32 pf_cache_hash(uint32 dfn)
+{
+	return dfn & (PF_CACHE_HASH_SIZE - 1);
+}
+
+void pf_cache_init()
+{
+	init_kspinlock(&PFCache.lock, "Page File Cache");
+	init_channel(&PFCache.busy_chan, "Page File Cache Busy");
+	LIST_INIT(&PFCache.lru);
+	for (int i = 0; i < PF_CACHE_HASH_SIZE; i++)
+		PFCache.buckets[i] = NULL;
+	for (int i = 0; i < PF_CACHE_NUM_BLOCKS; i++)
+	{
+		struct FrameInfo *ptr_frame_info;
+		allocate_frame(&ptr_frame_info);
+		ptr_frame_info->references = 1;
+		PFCache.blocks[i].data = STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(ptr_frame_info));
+		PFCache.blocks[i].valid = PFCache.blocks[i].dirty = PFCache.blocks[i].busy = 0;
+		PFCache.blocks[i].hnext = NULL;
+		LIST_INSERT_TAIL(&PFCache.lru, &PFCache.blocks[i]);
+	}
+	PFCache.hits = PFCache.misses = PFCache.writebacks = 0;
+}
+
+//The cache lock MUST be held
+static struct pf_cache_block* pf_cache_lookup(uint32 dfn)
+{
+	struct pf_cache_block *b = PFCache.buckets[pf_cache_hash(dfn)];
+	while (b != NULL && b->dfn != dfn)
+		b = b->hnext;
+	return b;
+}
+
+//The cache lock MUST be held
+static void pf_cache_unhash(struct pf_cache_block *blk)
+{
+	struct pf_cache_block **pb = &PFCache.buckets[pf_cache_hash(blk->dfn)];
+	while (*pb != blk)
+		pb = &((*pb)->hnext);
+	*pb = blk->hnext;
+	blk->hnext = NULL;
+	blk->valid = blk->dirty = 0;
+}
+
+//Make it the most recently used (the cache lock MUST be held)
+static inline void pf_cache_touch(struct pf_cache_block *blk)
+{
+	LIST_REMOVE(&PFCache.lru, blk);
+	LIST_INSERT_HEAD(&PFCache.lru, blk);
+}
+
+//Wait till the I/O of some busy block is done (the cache lock is released meanwhile)
+//The cache lock MUST be held
+static void pf_cache_wait()
+{
+	if (get_cpu_proc() != NULL)
+		sleep(&PFCache.busy_chan, &PFCache.lock);
+	else
+	{
+		//no env to block (e.g. a command of the kernel prompt): spin
+		release_kspinlock(&PFCache.lock);
+		cpu_pause();
+		acquire_kspinlock(&PFCache.lock);
+	}
+}
+
+//Mark the block done with its I/O & wake up its waiters (the cache lock MUST be held)
+static inline void pf_cache_unbusy(struct pf_cache_block *blk)
+{
+	blk->busy = 0;
+	wakeup_all(&PFCache.busy_chan);
+}
+
+//Take the least recently used (not busy) block for the given page, it's returned busy
+//(the caller fills it then calls pf_cache_unbusy()). The cache lock MUST be held
+//Returns NULL if the lock is released meanwhile (to write a dirty victim back or to
+//wait for a busy one), so the caller should look the page up again
+static struct pf_cache_block* pf_cache_replace(uint32 dfn)
+{
+	struct pf_cache_block *blk = LIST_LAST(&PFCache.lru);
+	while (blk != NULL && blk->busy)
+		blk = LIST_PREV(blk);
+	if (blk == NULL)
+	{
+		pf_cache_wait();
+		return NULL;
+	}
+	if (blk->valid && blk->dirty)
+	{
+		//write it back without the lock (it stays hashed: the users of its page wait for it)
+		blk->busy = 1;
+		release_kspinlock(&PFCache.lock);
+		__write_disk_page(blk->dfn, blk->data);
+		acquire_kspinlock(&PFCache.lock);
+		blk->dirty = 0;
+		PFCache.writebacks++;
+		pf_cache_unbusy(blk);
+		return NULL;
+	}
+	if (blk->valid)
+		pf_cache_unhash(blk);
+	blk->dfn = dfn;
+	blk->valid = 1;
+	blk->dirty = 0;
+	blk->busy = 1;
+	uint32 h = pf_cache_hash(dfn);
+	blk->hnext = PFCache.buckets[h];
+	PFCache.buckets[h] = blk;
+	return blk;
+}
+
+//Read the given page of the page file into va (from the cache if there)
+int pf_cache_read(uint32 dfn, void *va)
+{
+	int ret = 0;
+	acquire_kspinlock(&PFCache.lock);
+	{
+		struct pf_cache_block *blk;
+		for (;;)
+		{
+			blk = pf_cache_lookup(dfn);
+			if (blk != NULL)
+			{
+				if (blk->busy)
+				{
+					pf_cache_wait();
+					continue;
+				}
+				PFCache.hits++;
+				break;
+			}
+			if ((blk = pf_cache_replace(dfn)) == NULL)
+				continue;
+
+			PFCache.misses++;
+			release_kspinlock(&PFCache.lock);
+			ret = __read_disk_page(dfn, blk->data);
+			acquire_kspinlock(&PFCache.lock);
+			pf_cache_unbusy(blk);
+			if (ret != 0)
+			{
+				pf_cache_unhash(blk);
+				LIST_REMOVE(&PFCache.lru, blk);
+				LIST_INSERT_TAIL(&PFCache.lru, blk);
+				blk = NULL;
+			}
+			break;
+		}
+		if (blk != NULL)
+		{
+			memcpy(va, blk->data, PAGE_SIZE);
+			pf_cache_touch(blk);
+		}
+	}
+	release_kspinlock(&PFCache.lock);
+	return ret;
+}
+
+//Write the given page of the page file from va (to the cache only, it's written to the disk on eviction)
+int pf_cache_write(uint32 dfn, void *va)
+{
+	acquire_kspinlock(&PFCache.lock);
+	{
+		struct pf_cache_block *blk;
+		for (;;)
+		{
+			blk = pf_cache_lookup(dfn);
+			if (blk != NULL && blk->busy)
+			{
+				pf_cache_wait();
+				continue;
+			}
+			//(the whole page is overwritten, no need to read it)
+			if (blk == NULL && (blk = pf_cache_replace(dfn)) == NULL)
+				continue;
+			break;
+		}
+		memcpy(blk->data, va, PAGE_SIZE);
+		blk->dirty = 1;
+		blk->busy = 0;			//(if it's just taken by pf_cache_replace(), no one saw it busy)
+		pf_cache_touch(blk);
+	}
+	release_kspinlock(&PFCache.lock);
+	return 0;
+}
+
+//Drop the cached copy of the given page (without writing it), e.g. when its disk frame is freed
+void pf_cache_invalidate(uint32 dfn)
+{
+	acquire_kspinlock(&PFCache.lock);
+	{
+		struct pf_cache_block *blk;
+		while ((blk = pf_cache_lookup(dfn)) != NULL && blk->busy)
+			pf_cache_wait();
+		if (blk != NULL)
+		{
+			pf_cache_unhash(blk);
+			LIST_REMOVE(&PFCache.lru, blk);
+			LIST_INSERT_TAIL(&PFCache.lru, blk);
+		}
+	}
+	release_kspinlock(&PFCache.lock);
+}
+
+void pf_cache_print_stats()
+{
+	uint32 accesses = PFCache.hits + PFCache.misses;
+	cprintf("Page file cache: %d hits, %d misses (hit ratio = %d%%), %d write-backs\n",
+			PFCache.hits, PFCache.misses, accesses == 0 ? 0 : PFCache.hits * 100 / accesses, PFCache.writebacks);
+}
@@ -0,0 +1,47 @@
+#ifndef FOS_KERN_PF_CACHE_H
+#define FOS_KERN_PF_CACHE_H
+
+#ifndef FOS_KERNEL
+# error "This is a FOS kernel header; user programs should not #include it"
+#endif
+
+#include <inc/types.h>
+#include <inc/queue.h>
+#include <kern/conc/kspinlock.h>
+#include <kern/conc/channel.h>
+
+#define PF_CACHE_ENABLED		1
+#define PF_CACHE_NUM_BLOCKS		64		//num of cached pages of the page file (one frame each)
+#define PF_CACHE_HASH_SIZE		128		//num of buckets (MUST be power of 2)
+
+//A cached page of the page file
+struct pf_cache_block
+{
+	uint32 dfn;							//disk frame number
+	uint8 valid;
+	uint8 dirty;						//modified in the cache (written to the disk on eviction)
+	uint8 busy;							//its disk I/O is in progress (without the cache lock)
+	uint8 *data;						//kernel VA of its frame
+	struct pf_cache_block *hnext;		//next in the same hash bucket
+	LIST_ENTRY(pf_cache_block) prev_next_info;	//in the LRU list
+};
+LIST_HEAD(pf_cache_block_list, pf_cache_block);
+
+struct
+{
+	struct kspinlock lock;				//protects the blocks info (NOT held during the disk I/O)
+	struct Channel busy_chan;			//envs waiting for a busy block
+	struct pf_cache_block blocks[PF_CACHE_NUM_BLOCKS];
+	struct pf_cache_block *buckets[PF_CACHE_HASH_SIZE];
+	struct pf_cache_block_list lru;		//head: most recently used, tail: next victim
+	//stats
+	uint32 hits, misses, writebacks;
+} PFCache;
+
+void pf_cache_init();
+int pf_cache_read(uint32 dfn, void *va);
+int pf_cache_write(uint32 dfn, void *va);
+void pf_cache_invalidate(uint32 dfn);
+void pf_cache_print_stats();
+
+#endif /* FOS_KERN_PF_CACHE_H */
@@ -0,0 +1,428 @@
+/*
+ * Compressed page pool (in front of the page file)
+ *
+ * On page-out, the modified page is compressed (LZ4-like: literals + back references
+ * found by a hash of the next 4 bytes) into chunks of pool frames instead of being
+ * written to the disk. On page-in, the pool is checked first & the page is decompressed
+ * from there. Pages that are filled by the same 32-bit value (e.g. zeros) take no pool
+ * space at all. Pages that don't compress well (> ZSWAP_MAX_COMP_SIZE), or that don't
+ * fit in the pool (its size is capped by max_pool_frames), go to the disk as before.
+ *
+ * The stored copy is kept after page-in (the page is loaded clean, so it may be evicted
+ * again without being written). It's dropped when the page is stored again or when its
+ * disk frame is freed.
+ */
+
+#include "zswap.h"
+#include <inc/string.h>
+#include <inc/assert.h>
+#include <inc/error.h>
+#include <kern/proc/user_environment.h>
+#include "../mem/memory_manager.h"
+
+#define ZS_MIN_MATCH	4
+#define ZS_HASH_BITS	10
+
+static inline uint32 zswap_hash(uint32 dfn)
+{
+	return dfn & (ZSWAP_HASH_SIZE - 1);
+}
+
+void zswap_init()
+{
+	init_sleeplock(&ZSwap.lock, "Compressed Swap");
+	ZSwap.free_entries = NULL;
+	for (int i = ZSWAP_MAX_ENTRIES - 1; i >= 0; i--)
+	{
+		ZSwap.entries[i].hnext = ZSwap.free_entries;
+		ZSwap.free_entries = &ZSwap.entries[i];
+	}
+	for (int i = 0; i < ZSWAP_HASH_SIZE; i++)
+		ZSwap.buckets[i] = NULL;
+	for (int i = 0; i < ZSWAP_POOL_FRAMES_LIMIT; i++)
+	{
+		ZSwap.pool[i].frame_info = NULL;
+		ZSwap.pool[i].chunk_map = 0;
+	}
+	ZSwap.max_pool_frames = ZSWAP_DEF_POOL_FRAMES;
+	ZSwap.num_pool_frames = 0;
+	ZSwap.stored_pages = ZSwap.same_filled_pages = 0;
+	ZSwap.stores = ZSwap.rejects = ZSwap.loads = 0;
+	ZSwap.orig_bytes = ZSwap.comp_bytes = 0;
+}
+
+static inline void zswap_lock()
+{
+	if (get_cpu_proc() != NULL)
+		acquire_sleeplock(&ZSwap.lock);
+}
+static inline void zswap_unlock()
+{
+	if (get_cpu_proc() != NULL)
+		release_sleeplock(&ZSwap.lock);
+}
+
+//==================================================================================//
+//================================ COMPRESSOR ======================================//
+//==================================================================================//
+/* Format: a sequence of [token][literal length ext][literals][offset (2 bytes)][match length ext]
+ *  token: high 4 bits = num of literals, low 4 bits = match length - ZS_MIN_MATCH
+ *  (15 in any of them means more bytes follow: added till a byte < 255)
+ *  The last sequence has literals only (no offset/match)
+ */
+
+static inline uint32 zs_read32(const uint8 *p)
+{
+	return *(const uint32 *)p;
+}
+static inline uint32 zs_hash4(uint32 v)
+{
+	return (v * 2654435761U) >> (32 - ZS_HASH_BITS);
+}
+
+static uint8* zs_put_length(uint8 *op, uint32 len)
+{
+	while (len >= 255)
+	{
+		*op++ = 255;
+		len -= 255;
+	}
+	*op++ = len;
+	return op;
+}
+
+//Emit one sequence. Returns the new output pointer or NULL if it doesn't fit in [op, oend)
+static uint8* zs_emit(uint8 *op, uint8 *oend, const uint8 *lit, uint32 nlit, uint32 offset, uint32 mlen, bool last)
+{
+	//worst case size of the sequence
+	if (op + 1 + nlit / 255 + 1 + nlit + 2 + mlen / 255 + 1 > oend)
+		return NULL;
+	uint8 *token = op++;
+	*token = (nlit >= 15 ? 15 : nlit) << 4;
+	if (nlit >= 15)
+		op = zs_put_length(op, nlit - 15);
+	memcpy(op, lit, nlit);
+	op += nlit;
+	if (last)
+		return op;
+	*op++ = offset & 0xFF;
+	*op++ = (offset >> 8) & 0xFF;
+	*token |= (mlen >= 15 ? 15 : mlen);
+	if (mlen >= 15)
+		op = zs_put_length(op, mlen - 15);
+	return op;
+}
+
+//Compress n bytes of src into dst. Returns the compressed size or 0 if it exceeds max
+static uint32 zs_compress(const uint8 *src, uint32 n, uint8 *dst, uint32 max)
+{
+	const uint8 *ip = src, *anchor = src, *end = src + n;
+	uint8 *op = dst, *oend = dst + max;
+	memset(ZSwap.hash_table, 0, sizeof(ZSwap.hash_table));
+
+	while (ip + ZS_MIN_MATCH <= end)
+	{
+		uint32 seq = zs_read32(ip);
+		uint32 h = zs_hash4(seq);
+		const uint8 *ref = src + ZSwap.hash_table[h];
+		ZSwap.hash_table[h] = ip - src;
+		if (ref < ip && zs_read32(ref) == seq)
+		{
+			const uint8 *mp = ip + ZS_MIN_MATCH, *rp = ref + ZS_MIN_MATCH;
+			while (mp < end && *mp == *rp)
+			{
+				mp++;
+				rp++;
+			}
+			op = zs_emit(op, oend, anchor, ip - anchor, ip - ref, mp - ip - ZS_MIN_MATCH, 0);
+			if (op == NULL)
+				return 0;
+			ip = anchor = mp;
+		}
+		else
+			ip++;
+	}
+	op = zs_emit(op, oend, anchor, end - anchor, 0, 0, 1);
+	if (op == NULL)
+		return 0;
+	return op - dst;
+}
+
+//Decompress n bytes of src into dst (of size max). Returns the decompressed size or -1 if corrupted
+static int zs_decompress(const uint8 *src, uint32 n, uint8 *dst, uint32 max)
+{
+	const uint8 *ip = src, *iend = src + n;
+	uint8 *op = dst, *oend = dst + max;
+	while (ip < iend)
+	{
+		uint8 token = *ip++;
+		uint32 nlit = token >> 4;
+		if (nlit == 15)
+		{
+			uint8 b;
+			do { b = *ip++; nlit += b; } while (b == 255 && ip < iend);
+		}
+		if (op + nlit > oend || ip + nlit > iend)
+			return -1;
+		memcpy(op, ip, nlit);
+		op += nlit;
+		ip += nlit;
+		if (ip >= iend)
+			break;			//last sequence
+
+		uint32 offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		uint32 mlen = token & 0xF;
+		if (mlen == 15)
+		{
+			uint8 b;
+			do { b = *ip++; mlen += b; } while (b == 255 && ip < iend);
+		}
+		mlen += ZS_MIN_MATCH;
+		if (offset == 0 || offset > (uint32)(op - dst) || op + mlen > oend)
+			return -1;
+		//byte by byte since the match may overlap the output (e.g. a run)
+		const uint8 *mp = op - offset;
+		while (mlen-- > 0)
+			*op++ = *mp++;
+	}
+	return op - dst;
+}
+
+//Is the page filled by the same 32-bit value?
+static bool zs_same_filled(const void *va, uint32 *fill)
+{
+	const uint32 *p = va;
+	for (int i = 1; i < PAGE_SIZE / 4; i++)
+		if (p[i] != p[0])
+			return 0;
+	*fill = p[0];
+	return 1;
+}
+
+//==================================================================================//
+//=================================== POOL =========================================//
+//==================================================================================//
+
+//Find n contiguous free chunks in the pool (growing it if allowed).
+//Returns the pool frame index (& the first chunk in *first) or -1 if no space
+//The zswap lock MUST be held
+static int zswap_alloc_chunks(uint32 n, uint8 *first)
+{
+	uint32 mask = (1 << n) - 1;
+	int empty = -1;
+	for (int f = 0; f < ZSWAP_POOL_FRAMES_LIMIT; f++)
+	{
+		struct zswap_pool_frame *pf = &ZSwap.pool[f];
+		if (pf->frame_info == NULL)
+		{
+			if (empty < 0)
+				empty = f;
+			continue;
+		}
+		for (int c = 0; c + n <= ZSWAP_CHUNKS_PER_FRAME; c++)
+		{
+			if ((pf->chunk_map & (mask << c)) == 0)
+			{
+				pf->chunk_map |= mask << c;
+				*first = c;
+				return f;
+			}
+		}
+	}
+	//grow the pool by a new frame (unless it reaches its cap or the memory is scarce)
+	if (empty < 0 || ZSwap.num_pool_frames >= ZSwap.max_pool_frames ||
+			num_of_free_frames() < ZSWAP_MIN_FREE_FRAMES)
+		return -1;
+	struct zswap_pool_frame *pf = &ZSwap.pool[empty];
+	allocate_frame(&pf->frame_info);
+	pf->frame_info->references = 1;
+	pf->data = STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(pf->frame_info));
+	pf->chunk_map = mask;
+	ZSwap.num_pool_frames++;
+	*first = 0;
+	return empty;
+}
+
+//The zswap lock MUST be held
+static void zswap_free_chunks(int f, uint8 first, uint8 n)
+{
+	struct zswap_pool_frame *pf = &ZSwap.pool[f];
+	pf->chunk_map &= ~(((1 << n) - 1) << first);
+	if (pf->chunk_map == 0)
+	{
+		pf->frame_info->references = 0;
+		free_frame(pf->frame_info);
+		pf->frame_info = NULL;
+		ZSwap.num_pool_frames--;
+	}
+}
+
+//The zswap lock MUST be held
+static struct zswap_entry* zswap_lookup(uint32 dfn)
+{
+	struct zswap_entry *ent = ZSwap.buckets[zswap_hash(dfn)];
+	while (ent != NULL && ent->dfn != dfn)
+		ent = ent->hnext;
+	return ent;
+}
+
+//Unhash the entry & free its chunks (the zswap lock MUST be held)
+static void zswap_remove(struct zswap_entry *ent)
+{
+	struct zswap_entry **pe = &ZSwap.buckets[zswap_hash(ent->dfn)];
+	while (*pe != ent)
+		pe = &((*pe)->hnext);
+	*pe = ent->hnext;
+
+	if (ent->frame >= 0)
+		zswap_free_chunks(ent->frame, ent->first_chunk, ent->nchunks);
+	else
+		ZSwap.same_filled_pages--;
+	ZSwap.stored_pages--;
+	ZSwap.orig_bytes -= PAGE_SIZE;
+	ZSwap.comp_bytes -= ent->length;
+	ent->env->nZswapPages--;
+
+	ent->hnext = ZSwap.free_entries;
+	ZSwap.free_entries = ent;
+}
+
+//==================================================================================//
+//================================ INTERFACE =======================================//
+//==================================================================================//
+
+//Store the given page (of the given env) of the page file from va in the pool
+//Returns 0 if stored, E_NO_MEM if not (it should be written to the disk then)
+int zswap_store(struct Env *e, uint32 dfn, void *va)
+{
+	int ret = 0;
+	zswap_lock();
+	{
+		//the old stored copy (if any) is stale now
+		struct zswap_entry *ent = zswap_lookup(dfn);
+		if (ent != NULL)
+			zswap_remove(ent);
+
+		uint32 fill = 0, len = 0;
+		int frame = -1;
+		uint8 first = 0, nchunks = 0;
+		if (ZSwap.free_entries == NULL)
+			ret = E_NO_MEM;
+		else if (!zs_same_filled(va, &fill))
+		{
+			len = zs_compress(va, PAGE_SIZE, ZSwap.buffer, ZSWAP_MAX_COMP_SIZE);
+			if (len == 0)
+				ret = E_NO_MEM;
+			else
+			{
+				nchunks = ROUNDUP(len, ZSWAP_CHUNK_SIZE) / ZSWAP_CHUNK_SIZE;
+				frame = zswap_alloc_chunks(nchunks, &first);
+				if (frame < 0)
+					ret = E_NO_MEM;
+				else
+					memcpy(ZSwap.pool[frame].data + first * ZSWAP_CHUNK_SIZE, ZSwap.buffer, len);
+			}
+		}
+
+		if (ret == 0)
+		{
+			ent = ZSwap.free_entries;
+			ZSwap.free_entries = ent->hnext;
+			ent->dfn = dfn;
+			ent->env = e;
+			ent->frame = frame;
+			ent->first_chunk = first;
+			ent->nchunks = nchunks;
+			ent->length = len;
+			ent->fill = fill;
+			uint32 h = zswap_hash(dfn);
+			ent->hnext = ZSwap.buckets[h];
+			ZSwap.buckets[h] = ent;
+
+			ZSwap.stores++;
+			ZSwap.stored_pages++;
+			if (frame < 0)
+				ZSwap.same_filled_pages++;
+			ZSwap.orig_bytes += PAGE_SIZE;
+			ZSwap.comp_bytes += len;
+			e->nZswapPages++;
+			e->nZswapStores++;
+			e->nZswapOrigBytes += PAGE_SIZE;
+			e->nZswapCompBytes += len;
+		}
+		else
+			ZSwap.rejects++;
+	}
+	zswap_unlock();
+	return ret;
+}
+
+//Load the given page of the page file into va if it's stored in the pool
+//Returns 0 if loaded, E_PAGE_NOT_EXIST_IN_PF if not (it should be read from the disk then)
+int zswap_load(uint32 dfn, void *va)
+{
+	int ret = 0;
+	zswap_lock();
+	{
+		struct zswap_entry *ent = zswap_lookup(dfn);
+		if (ent == NULL)
+			ret = E_PAGE_NOT_EXIST_IN_PF;
+		else if (ent->frame < 0)
+		{
+			uint32 *p = va;
+			for (int i = 0; i < PAGE_SIZE / 4; i++)
+				p[i] = ent->fill;
+			ZSwap.loads++;
+		}
+		else
+		{
+			uint8 *src = ZSwap.pool[ent->frame].data + ent->first_chunk * ZSWAP_CHUNK_SIZE;
+			if (zs_decompress(src, ent->length, va, PAGE_SIZE) != PAGE_SIZE)
+				panic("zswap_load: corrupted compressed page (dfn = %d)", dfn);
+			ZSwap.loads++;
+		}
+	}
+	zswap_unlock();
+	return ret;
+}
+
+//Drop the stored copy of the given page, e.g. when its disk frame is freed
+void zswap_invalidate(uint32 dfn)
+{
+	zswap_lock();
+	{
+		struct zswap_entry *ent = zswap_lookup(dfn);
+		if (ent != NULL)
+			zswap_remove(ent);
+	}
+	zswap_unlock();
+}
+
+//Set the size cap of the pool. If it's less than the current size, the pool is not shrunk
+//immediately: it just doesn't grow till its frames are freed by page-ins/frees
+void zswap_set_max_pool_frames(uint32 nframes)
+{
+	if (nframes > ZSWAP_POOL_FRAMES_LIMIT)
+		nframes = ZSWAP_POOL_FRAMES_LIMIT;
+	ZSwap.max_pool_frames = nframes;
+}
+
+void zswap_print_stats()
+{
+	cprintf("Compressed swap: %d pages stored (%d same-filled) in %d of max %d frames, %d stores, %d rejects, %d loads\n",
+			ZSwap.stored_pages, ZSwap.same_filled_pages, ZSwap.num_pool_frames, ZSwap.max_pool_frames,
+			ZSwap.stores, ZSwap.rejects, ZSwap.loads);
+	cprintf("                 compressed size = %d%% of the original (%d KB -> %d KB)\n",
+			ZSwap.orig_bytes == 0 ? 0 : ZSwap.comp_bytes / (ZSwap.orig_bytes / 100),
+			ZSwap.orig_bytes / 1024, ZSwap.comp_bytes / 1024);
+	for (int i = 0; i < NENV; i++)
+	{
+		struct Env *e = &envs[i];
+		if (e->env_status == ENV_FREE || e->nZswapStores == 0)
+			continue;
+		cprintf("  [%d] %s: %d pages stored now, %d stores, compressed size = %d%% of the original\n",
+				e->env_id, e->prog_name, e->nZswapPages, e->nZswapStores,
+				e->nZswapCompBytes / (e->nZswapOrigBytes / 100));
+	}
+}
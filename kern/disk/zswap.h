@@ -0,0 +1,69 @@
+#ifndef FOS_KERN_ZSWAP_H
+#define FOS_KERN_ZSWAP_H
+
+#ifndef FOS_KERNEL
+# error "This is a FOS kernel header; user programs should not #include it"
+#endif
+
+#include <inc/types.h>
+#include <inc/mmu.h>
+#include <kern/conc/sleeplock.h>
+
+struct Env;
+struct FrameInfo;
+
+#define ZSWAP_ENABLED				1
+#define ZSWAP_CHUNK_SIZE			256								//unit of allocation inside a pool frame
+#define ZSWAP_CHUNKS_PER_FRAME		(PAGE_SIZE / ZSWAP_CHUNK_SIZE)	//(16: one bit each in the frame chunk map)
+#define ZSWAP_MAX_COMP_SIZE			(PAGE_SIZE * 3 / 4)				//pages that compress worse than this go to the disk
+#define ZSWAP_POOL_FRAMES_LIMIT		1024							//max value of the pool size cap (4MB)
+#define ZSWAP_DEF_POOL_FRAMES		256								//default pool size cap (1MB)
+#define ZSWAP_MAX_ENTRIES			4096							//max num of stored pages
+#define ZSWAP_HASH_SIZE				1024							//num of buckets (MUST be power of 2)
+#define ZSWAP_MIN_FREE_FRAMES		64								//don't grow the pool if the free frames are less than this
+
+//A page of the page file that's stored (compressed) in the pool instead of the disk
+struct zswap_entry
+{
+	uint32 dfn;							//disk frame number of the page
+	struct Env *env;					//owner (for its counters)
+	int16 frame;						//index of its pool frame (-1: same-filled page, no pool space)
+	uint8 first_chunk, nchunks;			//its chunks inside the pool frame
+	uint16 length;						//compressed size in bytes
+	uint32 fill;						//the value of a same-filled page
+	struct zswap_entry *hnext;			//next in the same hash bucket (or in the free list)
+};
+
+//A frame of the pool
+struct zswap_pool_frame
+{
+	struct FrameInfo *frame_info;		//NULL: not allocated
+	uint8 *data;						//kernel VA of the frame
+	uint16 chunk_map;					//bit i = chunk i is used
+};
+
+struct
+{
+	struct sleeplock lock;				//(used only when there's an env, like the disk driver)
+	struct zswap_entry entries[ZSWAP_MAX_ENTRIES];
+	struct zswap_entry *free_entries;
+	struct zswap_entry *buckets[ZSWAP_HASH_SIZE];
+	struct zswap_pool_frame pool[ZSWAP_POOL_FRAMES_LIMIT];
+	uint32 max_pool_frames;				//size cap of the pool (in frames)
+	uint32 num_pool_frames;				//currently allocated frames of the pool
+	uint16 hash_table[1 << 10];			//compressor work area
+	uint8 buffer[PAGE_SIZE];			//compressor output
+	//stats
+	uint32 stored_pages, same_filled_pages;
+	uint32 stores, rejects, loads;
+	uint32 orig_bytes, comp_bytes;		//of the currently stored pages
+} ZSwap;
+
+void zswap_init();
+int zswap_store(struct Env *e, uint32 dfn, void *va);
+int zswap_load(uint32 dfn, void *va);
+void zswap_invalidate(uint32 dfn);
+void zswap_set_max_pool_frames(uint32 nframes);
+void zswap_print_stats();
+
+#endif /* FOS_KERN_ZSWAP_H */
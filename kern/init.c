@@ -16,6 +16,7 @@
 #include <kern/cpu/cpu.h>
 #include <kern/cpu/sched.h>
 #include <kern/cpu/picirq.h>
+#include <kern/conc/futex.h>
 #include <kern/cpu/cpu.h>
 #include <kern/mem/boot_memory_manager.h>
 #include <kern/mem/kheap.h>
@@ -26,6 +27,7 @@
 #include <kern/tests/test_dynamic_allocator.h>
 #include <kern/tests/test_commands.h>
 #include <kern/disk/pagefile_manager.h>
+#include <kern/disk/disk_queue.h>
 
 //Functions Declaration
 //======================
@@ -84,6 +86,7 @@ void FOS_initialize()
 	cprintf("* 3) DISK...");
 	{
 		ide_init();
+		disk_queue_init();
 	}
 	cprintf("[DONE]\n");
 
@@ -115,6 +118,7 @@ void FOS_initialize()
 	{
 		kclock_init();
 		sched_init() ;
+		futex_init();
 	}
 	//cprintf("* [DONE]\n");
 
@@ -409,6 +409,9 @@ void turn_on_paging()
 	// Install page table.
 	lcr3(phys_page_directory);
 
+	//2025: allow 4MB pages (PTE_PS in a directory entry), used by the large shares
+	lcr4(rcr4() | CR4_PSE);
+
 	// Turn on paging.
 	uint32 cr0;
 	cr0 = rcr0();
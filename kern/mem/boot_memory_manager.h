@@ -27,9 +27,14 @@ char* ptr_free_mem;					// Pointer to next byte of free mem
 //struct FrameInfo* disk_frames_info;	// Virtual address of physical frames_info array
 struct FrameInfo* frames_info;		// Virtual address of physical frames_info array
 
+/*2025*/ //Free frames are kept by a buddy allocator: free_lists[k] has the free blocks of
+//(1 << k) contiguous frames that start at a frame number multiple of (1 << k)
+#define MAX_FRAME_ORDER		10			//max block = 1024 frames (4MB, i.e. a large page)
+
 struct
 {
-	struct FrameInfo_List free_frame_list;		// Free list of physical frames_info
+	struct FrameInfo_List free_lists[MAX_FRAME_ORDER + 1];	// Free blocks of physical frames_info (by order)
+	uint32 num_free_frames;						// Total num of frames in the free blocks
 	struct FrameInfo_List modified_frame_list;	// Modified frame list for buffering
 	struct kspinlock mfllock;					// Lock to protect the frame info lists
 } MemFrameLists;
@@ -46,6 +46,375 @@ void tlb_invalidate(uint32 *ptr_page_directory, void *virtual_address)
 // frames_info are reference counted, and free frames are kept on a linked list.
 // --------------------------------------------------------------
 
+/*2025*/ //BUDDY ALLOCATOR
+// The free frames are kept as blocks of (1 << order) contiguous frames, each in the
+// free list of its order (by its first frame). A block of order k starts at a frame number
+// that's a multiple of (1 << k), so its buddy (the other half of the block of order k+1)
+// is at (frame number XOR (1 << k)). On free, the block is merged with its buddy as long
+// as the buddy is a free block of the same order.
+// Frames of an allocated block are individual frames afterwards (e.g. each one can be
+// freed alone by free_frame()), since the order is only tracked for the free blocks.
+
+//The MemFrameLists.mfllock MUST be held
+static inline void buddy_insert_block(struct FrameInfo *ptr_block, uint32 order)
+{
+	ptr_block->isFreeBlock = 1;
+	ptr_block->order = order;
+	LIST_INSERT_HEAD(&MemFrameLists.free_lists[order], ptr_block);
+}
+
+//The MemFrameLists.mfllock MUST be held
+static inline void buddy_remove_block(struct FrameInfo *ptr_block)
+{
+	LIST_REMOVE(&MemFrameLists.free_lists[ptr_block->order], ptr_block);
+	ptr_block->isFreeBlock = 0;
+}
+
+//Take a free block of the given order (splitting a larger one if needed)
+//Returns NULL if there's no such block. The MemFrameLists.mfllock MUST be held
+static struct FrameInfo* buddy_alloc_block(uint32 order)
+{
+	uint32 k = order;
+	while (k <= MAX_FRAME_ORDER && LIST_EMPTY(&MemFrameLists.free_lists[k]))
+		k++;
+	if (k > MAX_FRAME_ORDER)
+		return NULL;
+
+	struct FrameInfo *ptr_block = LIST_FIRST(&MemFrameLists.free_lists[k]);
+	buddy_remove_block(ptr_block);
+	//give back the upper halves
+	while (k > order)
+	{
+		k--;
+		buddy_insert_block(ptr_block + (1 << k), k);
+	}
+	MemFrameLists.num_free_frames -= (1 << order);
+	return ptr_block;
+}
+
+//Return the given block (merging it with its free buddies)
+//The MemFrameLists.mfllock MUST be held
+static void buddy_free_block(struct FrameInfo *ptr_block, uint32 order)
+{
+	uint32 frame_number = to_frame_number(ptr_block);
+	MemFrameLists.num_free_frames += (1 << order);
+	while (order < MAX_FRAME_ORDER)
+	{
+		uint32 buddy_number = frame_number ^ (1 << order);
+		if (buddy_number >= number_of_frames)
+			break;
+		struct FrameInfo *ptr_buddy = &frames_info[buddy_number];
+		if (!ptr_buddy->isFreeBlock || ptr_buddy->order != order)
+			break;
+		buddy_remove_block(ptr_buddy);
+		frame_number &= ~(1 << order);
+		order++;
+	}
+	buddy_insert_block(&frames_info[frame_number], order);
+}
+
+/*2025*/ //PRE-ZEROED FRAMES
+// A pool of free frames that are already zeroed (by non-temporal stores, so zeroing them
+// doesn't flush the caches) while the CPU has nothing else to do: in the scheduler idle
+// (before halting) & at the kernel prompt. allocate_frame_zeroed() takes one of them, so
+// the first touch of a page/table doesn't zero it on the fault path, and only zeroes
+// a frame synchronously if the pool is empty.
+// The pooled frames are still FREE (they're counted by num_of_free_frames())
+
+static struct
+{
+	struct kspinlock lock;
+	struct FrameInfo_List frames;
+	bool use_nt_stores;					//SSE2 is supported
+	//stats
+	uint32 hits, misses, filled;
+} ZeroedFrames;
+
+static void init_zeroed_frames()
+{
+	init_kspinlock(&ZeroedFrames.lock, "Zeroed Frames Lock");
+	LIST_INIT(&ZeroedFrames.frames);
+	uint32 edx;
+	cpuid(1, NULL, NULL, NULL, &edx);
+	ZeroedFrames.use_nt_stores = (edx & (1 << 26)) != 0;
+	ZeroedFrames.hits = ZeroedFrames.misses = ZeroedFrames.filled = 0;
+}
+
+//Zero up to 'max' free frames & add them to the pool (till it has ZEROED_POOL_SIZE frames)
+//It's skipped if the free frames are scarce or if it's called while the frame locks are held
+void fill_zeroed_frames(uint32 max)
+{
+	if (holding_kspinlock(&MemFrameLists.mfllock) || holding_kspinlock(&ZeroedFrames.lock))
+		return;
+	//the freed page tables are zeroed first (they're reused before any other frame)
+	clean_page_table_frames(max);
+	for (uint32 i = 0; i < max; i++)
+	{
+		if (LIST_SIZE(&ZeroedFrames.frames) >= ZEROED_POOL_SIZE ||
+				num_of_free_frames() - LIST_SIZE(&ZeroedFrames.frames) <= ZEROED_POOL_MIN_FREE)
+			break;
+		struct FrameInfo *ptr_frame_info;
+		allocate_frame(&ptr_frame_info);
+		void *va = STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(ptr_frame_info));
+		if (ZeroedFrames.use_nt_stores)
+			zero_page_nt(va);
+		else
+			memset(va, 0, PAGE_SIZE);
+
+		acquire_kspinlock(&ZeroedFrames.lock);
+		{
+			LIST_INSERT_HEAD(&ZeroedFrames.frames, ptr_frame_info);
+			ZeroedFrames.filled++;
+		}
+		release_kspinlock(&ZeroedFrames.lock);
+	}
+}
+
+//Take a frame from the pool (NULL if empty)
+//The ZeroedFrames.lock MUST be held
+static struct FrameInfo* __take_zeroed_frame()
+{
+	struct FrameInfo *ptr_frame_info = LIST_FIRST(&ZeroedFrames.frames);
+	if (ptr_frame_info != NULL)
+		LIST_REMOVE(&ZeroedFrames.frames, ptr_frame_info);
+	return ptr_frame_info;
+}
+
+static struct FrameInfo* take_zeroed_frame()
+{
+	struct FrameInfo *ptr_frame_info;
+	acquire_kspinlock(&ZeroedFrames.lock);
+	{
+		ptr_frame_info = __take_zeroed_frame();
+	}
+	release_kspinlock(&ZeroedFrames.lock);
+	return ptr_frame_info;
+}
+
+//Num of the frames in the pool
+uint32 num_of_zeroed_frames()
+{
+	return LIST_SIZE(&ZeroedFrames.frames);
+}
+
+//Return all the frames of the pool to the buddy allocator (e.g. to let them merge into larger blocks)
+//The MemFrameLists.mfllock MUST be held
+static void drain_zeroed_frames()
+{
+	struct FrameInfo *ptr_frame_info;
+	while ((ptr_frame_info = take_zeroed_frame()) != NULL)
+	{
+		initialize_frame_info(ptr_frame_info);
+		buddy_free_block(ptr_frame_info, 0);
+	}
+}
+
+void zeroed_frames_print_stats()
+{
+	uint32 allocs = ZeroedFrames.hits + ZeroedFrames.misses;
+	cprintf("Zeroed frames: %d in pool (max %d, %s stores), %d zeroed in idle time, %d allocs (%d%% from the pool)\n",
+			LIST_SIZE(&ZeroedFrames.frames), ZEROED_POOL_SIZE, ZeroedFrames.use_nt_stores ? "non-temporal" : "normal",
+			ZeroedFrames.filled, allocs, allocs == 0 ? 0 : ZeroedFrames.hits * 100 / allocs);
+}
+
+//
+// Allocates a physical frame that's filled by zeros (from the pool of the pre-zeroed frames
+// if any, otherwise it's zeroed here)
+// RETURNS
+//   0 -- on success
+//   If failed, it panic.
+//
+int allocate_frame_zeroed(struct FrameInfo **ptr_frame_info)
+{
+	acquire_kspinlock(&ZeroedFrames.lock);
+	{
+		*ptr_frame_info = __take_zeroed_frame();
+		if (*ptr_frame_info != NULL)
+			ZeroedFrames.hits++;
+		else
+			ZeroedFrames.misses++;
+	}
+	release_kspinlock(&ZeroedFrames.lock);
+	if (*ptr_frame_info != NULL)
+		initialize_frame_info(*ptr_frame_info);
+	else
+	{
+		allocate_frame(ptr_frame_info);
+		memset(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(*ptr_frame_info)), 0, PAGE_SIZE);
+	}
+	return 0;
+}
+
+/*2025*/ //PAGE TABLES POOL
+// The frames of the page tables (of the envs & their disk page tables) are allocated from
+// (& freed to) this pool instead of the kernel heap: a table is accessed by the static kernel
+// VA of its frame (no kheap VA<->PA translation) & the tables freed by env_free() are kept to
+// be reused by the next envs. They're zeroed in the idle time (by fill_zeroed_frames()),
+// so allocate_page_table_frame() mostly gives an already-zeroed table.
+// The pooled frames are still FREE (they're counted by num_of_free_frames()), including the
+// ones taken out of the lists while they're being zeroed (counted by 'cleaning').
+// Each table is taken separately (no batch per env_create(): the tables it needs depend on
+// the loaded pages of each segment, which are decided while loading them)
+
+static struct
+{
+	struct kspinlock lock;
+	struct FrameInfo_List clean;		//zeroed
+	struct FrameInfo_List dirty;		//freed, not zeroed yet
+	uint32 cleaning;					//taken from 'dirty' & being zeroed now (back to 'clean' after)
+	//stats
+	uint32 hits, misses, frees, cleaned;
+} PTFrames;
+
+static void init_page_table_frames()
+{
+	init_kspinlock(&PTFrames.lock, "Page Tables Pool Lock");
+	LIST_INIT(&PTFrames.clean);
+	LIST_INIT(&PTFrames.dirty);
+	PTFrames.cleaning = 0;
+	PTFrames.hits = PTFrames.misses = PTFrames.frees = PTFrames.cleaned = 0;
+}
+
+//Take any frame of the pool (the zeroed first). Sets *is_zeroed. Returns NULL if empty
+//The PTFrames.lock MUST be held
+static struct FrameInfo* __take_page_table_frame(bool *is_zeroed)
+{
+	*is_zeroed = 1;
+	struct FrameInfo *ptr_frame_info = LIST_FIRST(&PTFrames.clean);
+	if (ptr_frame_info != NULL)
+		LIST_REMOVE(&PTFrames.clean, ptr_frame_info);
+	else if ((ptr_frame_info = LIST_FIRST(&PTFrames.dirty)) != NULL)
+	{
+		LIST_REMOVE(&PTFrames.dirty, ptr_frame_info);
+		*is_zeroed = 0;
+	}
+	return ptr_frame_info;
+}
+
+static struct FrameInfo* take_page_table_frame(bool *is_zeroed)
+{
+	struct FrameInfo *ptr_frame_info;
+	acquire_kspinlock(&PTFrames.lock);
+	{
+		ptr_frame_info = __take_page_table_frame(is_zeroed);
+	}
+	release_kspinlock(&PTFrames.lock);
+	return ptr_frame_info;
+}
+
+//Return all the frames of the pool to the buddy allocator (e.g. to let them merge into larger blocks)
+//(the ones being zeroed now are left, they're back to the pool after)
+//The MemFrameLists.mfllock MUST be held
+static void drain_page_table_frames()
+{
+	struct FrameInfo *ptr_frame_info;
+	bool is_zeroed;
+	while ((ptr_frame_info = take_page_table_frame(&is_zeroed)) != NULL)
+	{
+		initialize_frame_info(ptr_frame_info);
+		buddy_free_block(ptr_frame_info, 0);
+	}
+}
+
+//Zero up to 'max' of the freed table frames of the pool
+void clean_page_table_frames(uint32 max)
+{
+	if (holding_kspinlock(&PTFrames.lock))
+		return;
+	for (uint32 i = 0; i < max; i++)
+	{
+		struct FrameInfo *ptr_frame_info;
+		acquire_kspinlock(&PTFrames.lock);
+		{
+			ptr_frame_info = LIST_FIRST(&PTFrames.dirty);
+			if (ptr_frame_info != NULL)
+			{
+				LIST_REMOVE(&PTFrames.dirty, ptr_frame_info);
+				PTFrames.cleaning++;		//(still pooled, so it's still counted as free)
+			}
+		}
+		release_kspinlock(&PTFrames.lock);
+		if (ptr_frame_info == NULL)
+			break;
+
+		void *va = STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(ptr_frame_info));
+		if (ZeroedFrames.use_nt_stores)
+			zero_page_nt(va);
+		else
+			memset(va, 0, PAGE_SIZE);
+
+		acquire_kspinlock(&PTFrames.lock);
+		{
+			LIST_INSERT_HEAD(&PTFrames.clean, ptr_frame_info);
+			PTFrames.cleaning--;
+			PTFrames.cleaned++;
+		}
+		release_kspinlock(&PTFrames.lock);
+	}
+}
+
+//
+// Allocates a zeroed frame for a page table (from the pool if any, otherwise a pre-zeroed frame)
+// Its references is set to 1, its table is accessed at STATIC_KERNEL_VIRTUAL_ADDRESS(its PA)
+// RETURNS
+//   0 -- on success
+//   If failed, it panic.
+//
+int allocate_page_table_frame(struct FrameInfo **ptr_frame_info)
+{
+	bool is_zeroed;
+	acquire_kspinlock(&PTFrames.lock);
+	{
+		*ptr_frame_info = __take_page_table_frame(&is_zeroed);
+		if (*ptr_frame_info != NULL)
+			PTFrames.hits++;
+		else
+			PTFrames.misses++;
+	}
+	release_kspinlock(&PTFrames.lock);
+	if (*ptr_frame_info != NULL)
+	{
+		initialize_frame_info(*ptr_frame_info);
+		if (!is_zeroed)
+			memset(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(*ptr_frame_info)), 0, PAGE_SIZE);
+	}
+	else
+		allocate_frame_zeroed(ptr_frame_info);
+	(*ptr_frame_info)->references = 1;
+	return 0;
+}
+
+//
+// Return the frame of a page table (allocated by allocate_page_table_frame()) to the pool,
+// or to the free frames if the pool is full
+// (This function should only be called when its references reaches 0.)
+//
+void free_page_table_frame(struct FrameInfo *ptr_frame_info)
+{
+	initialize_frame_info(ptr_frame_info);
+	bool pooled = 0;
+	acquire_kspinlock(&PTFrames.lock);
+	{
+		PTFrames.frees++;
+		if (LIST_SIZE(&PTFrames.clean) + LIST_SIZE(&PTFrames.dirty) + PTFrames.cleaning < PT_POOL_SIZE)
+		{
+			LIST_INSERT_HEAD(&PTFrames.dirty, ptr_frame_info);
+			pooled = 1;
+		}
+	}
+	release_kspinlock(&PTFrames.lock);
+	if (!pooled)
+		free_frame(ptr_frame_info);
+}
+
+void page_table_frames_print_stats()
+{
+	uint32 allocs = PTFrames.hits + PTFrames.misses;
+	cprintf("Page tables pool: %d zeroed + %d to zero (max %d), %d tables freed, %d zeroed in idle time, %d allocs (%d%% from the pool)\n",
+			LIST_SIZE(&PTFrames.clean), LIST_SIZE(&PTFrames.dirty), PT_POOL_SIZE,
+			PTFrames.frees, PTFrames.cleaned, allocs, allocs == 0 ? 0 : PTFrames.hits * 100 / allocs);
+}
+
 // Initialize paging structure and free_frame_list.
 // After this point, ONLY use the functions below
 // to allocate and deallocate physical memory via the free_frame_list,
@@ -69,7 +438,9 @@ void initialize_paging()
 	//
 	// Change the code to reflect this.
 	int i;
-	LIST_INIT(&MemFrameLists.free_frame_list);
+	for (i = 0; i <= MAX_FRAME_ORDER; i++)
+		LIST_INIT(&MemFrameLists.free_lists[i]);
+	MemFrameLists.num_free_frames = 0;
 	LIST_INIT(&MemFrameLists.modified_frame_list);
 
 	//Initialize the corresponding lock
@@ -95,7 +466,7 @@ void initialize_paging()
 		initialize_frame_info(&(frames_info[i]));
 		//frames_info[i].references = 0;
 
-		LIST_INSERT_HEAD(&MemFrameLists.free_frame_list, &frames_info[i]);
+		buddy_free_block(&frames_info[i], 0);
 	}
 
 	for (i = PHYS_IO_MEM/PAGE_SIZE ; i < PHYS_EXTENDED_MEM/PAGE_SIZE; i++)
@@ -115,9 +486,11 @@ void initialize_paging()
 		initialize_frame_info(&(frames_info[i]));
 
 		//frames_info[i].references = 0;
-		LIST_INSERT_HEAD(&MemFrameLists.free_frame_list, &frames_info[i]);
+		buddy_free_block(&frames_info[i], 0);
 	}
 
+	init_zeroed_frames();
+	init_page_table_frames();
 	initialize_disk_page_file();
 }
 
@@ -131,6 +504,104 @@ void initialize_frame_info(struct FrameInfo *ptr_frame_info)
 	memset(ptr_frame_info, 0, sizeof(*ptr_frame_info));
 }
 
+/*2025*/ //PER-CPU FRAME CACHES
+// Single frames are allocated from/freed to a small stack of free frames of the current
+// CPU, so the page fault (& the other single frame) paths take the MemFrameLists.mfllock
+// only once per FRAME_CACHE_BATCH frames: to refill the cache from the buddy allocator
+// when it's empty, or to drain the oldest half of it back when it's full.
+// The cached frames are still FREE (they're counted by num_of_free_frames())
+
+struct frame_cache FrameCaches[NCPUS];
+
+//Take a batch of frames from the buddy allocator (panics if none)
+//MUST be called with the interrupts disabled (pushcli)
+static void frame_cache_refill(struct frame_cache *cache)
+{
+	bool lock_already_held = holding_kspinlock(&MemFrameLists.mfllock);
+	if (!lock_already_held)
+		acquire_kspinlock(&MemFrameLists.mfllock);
+	{
+		struct FrameInfo *ptr_frame_info;
+		while (cache->count < FRAME_CACHE_BATCH && (ptr_frame_info = buddy_alloc_block(0)) != NULL)
+			cache->frames[cache->count++] = ptr_frame_info;
+		cache->refills++;
+	}
+	if (!lock_already_held)
+		release_kspinlock(&MemFrameLists.mfllock);
+
+	if (cache->count == 0)
+	{
+		//the last free frames may be in the pools of the pre-zeroed frames & the page tables
+		bool is_zeroed;
+		struct FrameInfo *ptr_frame_info = take_zeroed_frame();
+		if (ptr_frame_info == NULL)
+			ptr_frame_info = take_page_table_frame(&is_zeroed);
+		if (ptr_frame_info == NULL)
+			panic("ERROR: Kernel run out of memory... allocate_frame cannot find a free frame.\n");
+		cache->frames[cache->count++] = ptr_frame_info;
+	}
+}
+
+//Return the oldest 'n' frames of the cache (at its bottom) to the buddy allocator
+//MUST be called with the interrupts disabled (pushcli)
+static void frame_cache_drain(struct frame_cache *cache, uint32 n)
+{
+	if (n > cache->count)
+		n = cache->count;
+	bool lock_already_held = holding_kspinlock(&MemFrameLists.mfllock);
+	if (!lock_already_held)
+		acquire_kspinlock(&MemFrameLists.mfllock);
+	{
+		for (uint32 i = 0; i < n; i++)
+			buddy_free_block(cache->frames[i], 0);
+		cache->drains++;
+	}
+	if (!lock_already_held)
+		release_kspinlock(&MemFrameLists.mfllock);
+
+	for (uint32 i = n; i < cache->count; i++)
+		cache->frames[i - n] = cache->frames[i];
+	cache->count -= n;
+}
+
+//Return all the frames of the cache of this CPU to the buddy allocator
+//(e.g. to let them merge into larger blocks)
+void drain_frame_cache()
+{
+	pushcli();
+	{
+		struct frame_cache *cache = &FrameCaches[mycpu() - CPUS];
+		frame_cache_drain(cache, cache->count);
+	}
+	popcli();
+}
+
+//Num of the free frames (in the buddy allocator, the frame caches & the pools of the pre-zeroed frames & the page tables)
+uint32 num_of_free_frames()
+{
+	uint32 n = MemFrameLists.num_free_frames + LIST_SIZE(&ZeroedFrames.frames)
+			+ LIST_SIZE(&PTFrames.clean) + LIST_SIZE(&PTFrames.dirty) + PTFrames.cleaning;
+	for (int c = 0; c < NCPUS; c++)
+		n += FrameCaches[c].count;
+	return n;
+}
+
+void frame_cache_print_stats(bool reset)
+{
+	for (int c = 0; c < NCPUS; c++)
+	{
+		struct frame_cache *cache = &FrameCaches[c];
+		uint32 saved = (cache->allocs - cache->refills) + (cache->frees - cache->drains);
+		cprintf("frame cache CPU%d: %d cached, %d allocs (%d%% hits), %d frees (%d%% hits), %d refills, %d drains => %d mfllock acquisitions saved\n",
+				c, cache->count,
+				cache->allocs, cache->allocs == 0 ? 0 : cache->alloc_hits * 100 / cache->allocs,
+				cache->frees, cache->frees == 0 ? 0 : cache->free_hits * 100 / cache->frees,
+				cache->refills, cache->drains, saved);
+		if (reset)
+			cache->allocs = cache->alloc_hits = cache->frees = cache->free_hits = cache->refills = cache->drains = 0;
+	}
+}
+
 //
 // Allocates a physical frame.
 // Does NOT set the contents of the physical frame to zero -
@@ -147,22 +618,19 @@ void initialize_frame_info(struct FrameInfo *ptr_frame_info)
 // Hint: references should not be incremented
 int allocate_frame(struct FrameInfo **ptr_frame_info)
 {
-	bool lock_already_held = holding_kspinlock(&MemFrameLists.mfllock);
-
-	if (!lock_already_held)
+	//2025: served by the frame cache of this CPU (refilled from the buddy allocator by a batch)
+	pushcli();
 	{
-		acquire_kspinlock(&MemFrameLists.mfllock);
-	}
-
-	*ptr_frame_info = LIST_FIRST(&MemFrameLists.free_frame_list);
-	int c = 0;
+		struct frame_cache *cache = &FrameCaches[mycpu() - CPUS];
+		cache->allocs++;
+		if (cache->count == 0)
+			frame_cache_refill(cache);
+		else
+			cache->alloc_hits++;
 
-	if (*ptr_frame_info == NULL)
-	{
-		panic("ERROR: Kernel run out of memory... allocate_frame cannot find a free frame.\n");
+		*ptr_frame_info = cache->frames[--(cache->count)];
 	}
-
-	LIST_REMOVE(&MemFrameLists.free_frame_list,*ptr_frame_info);
+	popcli();
 
 	/******************* PAGE BUFFERING CODE *******************
 	 ***********************************************************/
@@ -178,11 +646,6 @@ int allocate_frame(struct FrameInfo **ptr_frame_info)
 
 	initialize_frame_info(*ptr_frame_info);
 
-	if (!lock_already_held)
-	{
-		release_kspinlock(&MemFrameLists.mfllock);
-	}
-
 	return 0;
 }
 
@@ -192,24 +655,272 @@ int allocate_frame(struct FrameInfo **ptr_frame_info)
 //
 void free_frame(struct FrameInfo *ptr_frame_info)
 {
-	bool lock_already_held = holding_kspinlock(&MemFrameLists.mfllock);
+	/*2012: clear it to ensure that its members (env, isBuffered, ...) become NULL*/
+	initialize_frame_info(ptr_frame_info);
+	/*=============================================================================*/
 
-	if (!lock_already_held)
+	//2025: kept in the frame cache of this CPU (the oldest half is drained to the buddy allocator if full)
+	pushcli();
 	{
-		acquire_kspinlock(&MemFrameLists.mfllock);
+		struct frame_cache *cache = &FrameCaches[mycpu() - CPUS];
+		cache->frees++;
+		if (cache->count == FRAME_CACHE_SIZE)
+			frame_cache_drain(cache, FRAME_CACHE_BATCH);
+		else
+			cache->free_hits++;
+		cache->frames[cache->count++] = ptr_frame_info;
+		//LOG_STATMENT(cprintf("FN # %d FREED",to_frame_number(ptr_frame_info)));
 	}
+	popcli();
+}
+
+//
+// Allocates (1 << order) contiguous physical frames that start at a frame number
+// multiple of (1 << order). Their contents are NOT set to zero.
+// *ptr_frame_info is set to the first of them (references are NOT incremented)
+//
+// RETURNS
+//   0 -- on success
+//   E_INVAL -- if order > MAX_FRAME_ORDER
+//   E_NO_MEM -- if there's no such free range (unlike allocate_frame(), it doesn't panic)
+//
+int allocate_frames(uint32 order, struct FrameInfo **ptr_frame_info)
+{
+	*ptr_frame_info = NULL;
+	if (order > MAX_FRAME_ORDER)
+		return E_INVAL;
+
+	bool lock_already_held = holding_kspinlock(&MemFrameLists.mfllock);
+	if (!lock_already_held)
+		acquire_kspinlock(&MemFrameLists.mfllock);
 	{
-		/*2012: clear it to ensure that its members (env, isBuffered, ...) become NULL*/
-		initialize_frame_info(ptr_frame_info);
-		/*=============================================================================*/
-		// Fill this function in
-		LIST_INSERT_HEAD(&MemFrameLists.free_frame_list, ptr_frame_info);
-		//LOG_STATMENT(cprintf("FN # %d FREED",to_frame_number(ptr_frame_info)));
+		*ptr_frame_info = buddy_alloc_block(order);
+		if (*ptr_frame_info == NULL && order > 0)
+		{
+			//the frames in the cache of this CPU & the pooled ones may complete a block: return them then retry
+			drain_frame_cache();
+			drain_zeroed_frames();
+			drain_page_table_frames();
+			*ptr_frame_info = buddy_alloc_block(order);
+		}
+		if (*ptr_frame_info != NULL)
+		{
+			for (uint32 i = 0; i < (1 << order); i++)
+				initialize_frame_info(&(*ptr_frame_info)[i]);
+		}
 	}
 	if (!lock_already_held)
+		release_kspinlock(&MemFrameLists.mfllock);
+
+	return *ptr_frame_info == NULL ? E_NO_MEM : 0;
+}
+
+//
+// Return the (1 << order) contiguous frames that start at ptr_frame_info
+// (allocated by allocate_frames()) to the free lists.
+// (This function should only be called when the references of all of them are 0.)
+//
+void free_frames(struct FrameInfo *ptr_frame_info, uint32 order)
+{
+	assert(order <= MAX_FRAME_ORDER && to_frame_number(ptr_frame_info) % (1 << order) == 0);
+
+	bool lock_already_held = holding_kspinlock(&MemFrameLists.mfllock);
+	if (!lock_already_held)
+		acquire_kspinlock(&MemFrameLists.mfllock);
 	{
+		for (uint32 i = 0; i < (1 << order); i++)
+			initialize_frame_info(&ptr_frame_info[i]);
+		buddy_free_block(ptr_frame_info, order);
+	}
+	if (!lock_already_held)
 		release_kspinlock(&MemFrameLists.mfllock);
+}
+
+/*2025*/ //PAGE COLORING
+// The L2 cache is physically indexed, so the frames of the same color share the same group
+// of its sets: if the consecutive pages of a process get frames of the same color (e.g. by
+// the LIFO order of the free frames), they evict each other while the other sets are unused.
+// allocate_frame_colored() gives the page at a VA a frame of the VA's color, so the consecutive
+// pages are spread over all the sets. It's taken from the pre-zeroed pool (if a zeroed frame
+// is asked), then the cache of this CPU, then from a free block of the buddy allocator that
+// contains this color (splitting it around the frame), otherwise it's any free frame.
+
+static struct
+{
+	uint32 num;			//num of colors (power of 2, 1: coloring is off)
+	//stats (protected by the ZeroedFrames.lock, as the zeroed-pool stats they're updated with)
+	uint32 hits, misses;
+} FrameColors = { .num = DEF_FRAME_COLORS };
+
+//RETURNS: 0 on success, E_INVAL if it's not a power of 2 in [1, MAX_FRAME_COLORS]
+int set_num_of_frame_colors(uint32 num_of_colors)
+{
+	if (num_of_colors == 0 || num_of_colors > MAX_FRAME_COLORS || (num_of_colors & (num_of_colors - 1)) != 0)
+		return E_INVAL;
+	FrameColors.num = num_of_colors;
+	acquire_kspinlock(&ZeroedFrames.lock);
+	{
+		FrameColors.hits = FrameColors.misses = 0;
+	}
+	release_kspinlock(&ZeroedFrames.lock);
+	return 0;
+}
+
+uint32 get_num_of_frame_colors()
+{
+	return FrameColors.num;
+}
+
+//Index of the frame of the given color among the frames that start at frame_number
+static inline uint32 color_offset(uint32 frame_number, uint32 color)
+{
+	return (color - frame_number) & (FrameColors.num - 1);
+}
+
+//Take a free frame of the given color out of a free block (giving back the rest of the block)
+//Returns NULL if it's not found within the search limit. The MemFrameLists.mfllock MUST be held
+static struct FrameInfo* buddy_alloc_colored_frame(uint32 color)
+{
+	for (uint32 order = 0; order <= MAX_FRAME_ORDER; order++)
+	{
+		uint32 checked = 0;
+		struct FrameInfo *ptr_block;
+		LIST_FOREACH(ptr_block, &MemFrameLists.free_lists[order])
+		{
+			uint32 offset = color_offset(to_frame_number(ptr_block), color);
+			if (offset < (1 << order))
+			{
+				buddy_remove_block(ptr_block);
+				//give back the halves that don't contain the frame
+				while (order > 0)
+				{
+					order--;
+					if (offset & (1 << order))
+					{
+						buddy_insert_block(ptr_block, order);
+						ptr_block += (1 << order);
+					}
+					else
+						buddy_insert_block(ptr_block + (1 << order), order);
+				}
+				MemFrameLists.num_free_frames--;
+				return ptr_block;
+			}
+			if (++checked == FRAME_COLOR_SEARCH_LIMIT)
+				break;
+		}
 	}
+	return NULL;
+}
+
+//Take a frame of the given color from the pool of the pre-zeroed frames (NULL if none)
+//It's counted as a hit of both the pool & the coloring
+static struct FrameInfo* take_zeroed_colored_frame(uint32 color)
+{
+	struct FrameInfo *ptr_frame_info;
+	acquire_kspinlock(&ZeroedFrames.lock);
+	{
+		LIST_FOREACH(ptr_frame_info, &ZeroedFrames.frames)
+		{
+			if (color_offset(to_frame_number(ptr_frame_info), color) == 0)
+			{
+				LIST_REMOVE(&ZeroedFrames.frames, ptr_frame_info);
+				ZeroedFrames.hits++;
+				FrameColors.hits++;
+				break;
+			}
+		}
+	}
+	release_kspinlock(&ZeroedFrames.lock);
+	return ptr_frame_info;
+}
+
+//Count a colored allocation that's not from the pool: got the color or not (fallback),
+//& whether it's zeroed synchronously (a miss of the pool)
+static void count_colored_frame(bool colored, bool zeroed_here)
+{
+	acquire_kspinlock(&ZeroedFrames.lock);
+	{
+		if (colored)
+			FrameColors.hits++;
+		else
+			FrameColors.misses++;
+		if (zeroed_here)
+			ZeroedFrames.misses++;
+	}
+	release_kspinlock(&ZeroedFrames.lock);
+}
+
+//
+// Allocates a physical frame of the same color as the given VA (if coloring is on),
+// filled by zeros if 'zeroed' is set
+// RETURNS
+//   0 -- on success
+//   If failed, it panic.
+//
+int allocate_frame_colored(struct FrameInfo **ptr_frame_info, uint32 virtual_address, bool zeroed)
+{
+	if (FrameColors.num == 1)
+		return zeroed ? allocate_frame_zeroed(ptr_frame_info) : allocate_frame(ptr_frame_info);
+
+	uint32 color = PPN(virtual_address) & (FrameColors.num - 1);
+	*ptr_frame_info = NULL;
+	if (zeroed && (*ptr_frame_info = take_zeroed_colored_frame(color)) != NULL)
+	{
+		initialize_frame_info(*ptr_frame_info);
+		return 0;
+	}
+
+	pushcli();
+	{
+		struct frame_cache *cache = &FrameCaches[mycpu() - CPUS];
+		for (int i = cache->count - 1; i >= 0; i--)
+		{
+			if (color_offset(to_frame_number(cache->frames[i]), color) == 0)
+			{
+				*ptr_frame_info = cache->frames[i];
+				cache->frames[i] = cache->frames[--(cache->count)];
+				break;
+			}
+		}
+	}
+	popcli();
+
+	if (*ptr_frame_info == NULL)
+	{
+		bool lock_already_held = holding_kspinlock(&MemFrameLists.mfllock);
+		if (!lock_already_held)
+			acquire_kspinlock(&MemFrameLists.mfllock);
+		{
+			*ptr_frame_info = buddy_alloc_colored_frame(color);
+		}
+		if (!lock_already_held)
+			release_kspinlock(&MemFrameLists.mfllock);
+	}
+
+	if (*ptr_frame_info == NULL)
+	{
+		//(allocate_frame_zeroed() counts its own hit/miss of the pool)
+		count_colored_frame(0, 0);
+		return zeroed ? allocate_frame_zeroed(ptr_frame_info) : allocate_frame(ptr_frame_info);
+	}
+	count_colored_frame(1, zeroed);
+	initialize_frame_info(*ptr_frame_info);
+	if (zeroed)
+	{
+		memset(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(*ptr_frame_info)), 0, PAGE_SIZE);
+	}
+	return 0;
+}
+
+void frame_colors_print_stats()
+{
+	uint32 allocs = FrameColors.hits + FrameColors.misses;
+	if (FrameColors.num == 1)
+		cprintf("Page coloring: OFF\n");
+	else
+		cprintf("Page coloring: %d colors, %d colored allocs (%d%% got the VA's color)\n",
+				FrameColors.num, allocs, allocs == 0 ? 0 : FrameColors.hits * 100 / allocs);
 }
 
 //
@@ -240,15 +951,8 @@ int get_page_table(uint32 *ptr_page_directory, const uint32 virtual_address, uin
 	if ( (page_directory_entry & PERM_PRESENT) == PERM_PRESENT)
 	{
 		//	cprintf("gpt .07, page_directory_entry= %x \n",page_directory_entry);
-		if(USE_KHEAP && !CHECK_IF_KERNEL_ADDRESS(virtual_address))
-		{
-			*ptr_page_table = (void *)kheap_virtual_address(EXTRACT_ADDRESS(page_directory_entry)) ;
-			//cprintf("===>get_page_table: page_dir_entry = %x ptr_page_table = %x\n", page_directory_entry,*ptr_page_table);
-		}
-		else
-		{
-			*ptr_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(page_directory_entry)) ;
-		}
+		//2025: the tables are frames of the page tables pool (even with the KHEAP)
+		*ptr_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(page_directory_entry)) ;
 		return TABLE_IN_MEMORY;
 	}
 	else if (page_directory_entry != 0) //the table exists but not in main mem, so it must be in sec mem
@@ -265,14 +969,7 @@ int get_page_table(uint32 *ptr_page_directory, const uint32 virtual_address, uin
 		// now the page_fault_handler() should have returned successfully and updated the
 		// directory with the new table frame number in memory
 		page_directory_entry = ptr_page_directory[PDX(virtual_address)];
-		if(USE_KHEAP && !CHECK_IF_KERNEL_ADDRESS(virtual_address))
-		{
-			*ptr_page_table = (void *)kheap_virtual_address(EXTRACT_ADDRESS(page_directory_entry)) ;
-		}
-		else
-		{
-			*ptr_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(page_directory_entry)) ;
-		}
+		*ptr_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(page_directory_entry)) ;
 
 		return TABLE_IN_MEMORY;
 	}
@@ -298,26 +995,10 @@ void * create_page_table(uint32 *ptr_directory, const uint32 virtual_address)
 
 	//change this "return" according to your answer
 
-#if USE_KHEAP
-	uint32 * ptr_page_table = kmalloc(PAGE_SIZE);
-	//cprintf("new table is created==================\n");
-	if(ptr_page_table == NULL)
-	{
-		panic("NOT ENOUGH KERNEL HEAP SPACE");
-	}
-	//cprintf("Table is created for va %x\n", virtual_address);
-	ptr_directory[PDX(virtual_address)] = CONSTRUCT_ENTRY(
-			kheap_physical_address((unsigned int)ptr_page_table)
-			, PERM_PRESENT | PERM_USER | PERM_WRITEABLE);
-
-	//================
-	memset(ptr_page_table , 0, PAGE_SIZE);
-	tlbflush();
-
-#else
+	//2025: (even with the KHEAP) the table is a frame of the page tables pool, it's already
+	//zeroed & its PA is known, so there's no kmalloc() + kheap_physical_address() + memset()
 	uint32 * ptr_page_table ;
 	__static_cpt(ptr_directory, virtual_address, &ptr_page_table) ;
-#endif
 
 	//cprintf("KERNEL: NEW TABLE for va %x \n", virtual_address);
 
@@ -327,14 +1008,12 @@ void * create_page_table(uint32 *ptr_directory, const uint32 virtual_address)
 void __static_cpt(uint32 *ptr_directory, const uint32 virtual_address, uint32 **ptr_page_table)
 {
 	struct FrameInfo* ptr_new_frame_info;
-	int err = allocate_frame(&ptr_new_frame_info) ;
+	//initialize new page table by 0's (2025: a zeroed frame of the page tables pool, its references = 1)
+	int err = allocate_page_table_frame(&ptr_new_frame_info) ;
 
 	uint32 phys_page_table = to_physical_address(ptr_new_frame_info);
 	*ptr_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(phys_page_table) ;
-	ptr_new_frame_info->references = 1;
 	ptr_directory[PDX(virtual_address)] = CONSTRUCT_ENTRY(phys_page_table, PERM_PRESENT | PERM_USER | PERM_WRITEABLE);
-	//initialize new page table by 0's
-	memset(*ptr_page_table , 0, PAGE_SIZE);
 	tlbflush();
 }
 //
@@ -437,6 +1116,12 @@ int map_frame(uint32 *ptr_page_directory, struct FrameInfo *ptr_frame_info, uint
 //
 struct FrameInfo * get_frame_info(uint32 *ptr_page_directory, uint32 virtual_address, uint32 **ptr_page_table)
 {
+	/*2025*///a large (4MB) page has no table: return its frame that holds the given VA
+	if (is_large_page_mapped(ptr_page_directory, virtual_address))
+	{
+		*ptr_page_table = NULL;
+		return to_frame_info(EXTRACT_ADDRESS(ptr_page_directory[PDX(virtual_address)]) + PTX(virtual_address) * PAGE_SIZE);
+	}
 	// Fill this function in
 	uint32 ret =  get_page_table(ptr_page_directory, virtual_address, ptr_page_table) ;
 	if((*ptr_page_table) != 0)
@@ -473,6 +1158,12 @@ struct FrameInfo * get_frame_info(uint32 *ptr_page_directory, uint32 virtual_add
 //
 void unmap_frame(uint32 *ptr_page_directory, uint32 virtual_address)
 {
+	/*2025*///a large (4MB) page can only be unmapped as a whole
+	if (is_large_page_mapped(ptr_page_directory, virtual_address))
+	{
+		unmap_large_frame(ptr_page_directory, virtual_address);
+		return;
+	}
 	// Fill this function in
 	uint32 *ptr_page_table;
 	struct FrameInfo* ptr_frame_info = get_frame_info(ptr_page_directory, virtual_address, &ptr_page_table);
@@ -515,14 +1206,7 @@ int loadtime_map_frame(uint32 *ptr_page_directory, struct FrameInfo *ptr_frame_i
 
 	uint32 page_directory_entry = ptr_page_directory[PDX(virtual_address)];
 
-	if(USE_KHEAP && !CHECK_IF_KERNEL_ADDRESS(virtual_address))
-	{
-		ptr_page_table = (uint32*)kheap_virtual_address(EXTRACT_ADDRESS(page_directory_entry)) ;
-	}
-	else
-	{
-		ptr_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(page_directory_entry)) ;
-	}
+	ptr_page_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(page_directory_entry)) ;
 
 	//if page table not exist, create it in memory and link it with the directory
 	if (page_directory_entry == 0)
@@ -545,6 +1229,62 @@ int loadtime_map_frame(uint32 *ptr_page_directory, struct FrameInfo *ptr_frame_i
 }
 
 
+///============================================================================================
+/*2025*/ //LARGE (4MB) PAGES
+///============================================================================================
+//A large page is mapped directly by a page directory entry (PTE_PS, CR4.PSE is
+//turned on at boot), so 1024 pages cost a single TLB entry and no page table.
+//It occupies PAGE_SIZE*NPTENTRIES contiguous frames that start at a 4MB-aligned PA.
+//The mapping takes a reference on EACH of its frames, so the frames of a large page
+//can still be mapped/freed individually (e.g. a share that's mapped by 4KB pages in one env
+//and by a large page in another one)
+
+//
+// Allocates NPTENTRIES contiguous free frames that start at a 4MB-aligned PA
+// (i.e. a buddy block of MAX_FRAME_ORDER)
+// *ptr_frame_info is set to the first of them (references are NOT incremented)
+// RETURNS:
+//   0 -- on success
+//   E_NO_MEM -- if there's no such free range (unlike allocate_frame(), it doesn't panic)
+//
+int allocate_large_frame(struct FrameInfo **ptr_frame_info)
+{
+	static_assert((1 << MAX_FRAME_ORDER) == NPTENTRIES);
+	return allocate_frames(MAX_FRAME_ORDER, ptr_frame_info);
+}
+
+//
+// Map the large frame that starts at 'ptr_frame_info' at the 4MB-aligned 'virtual_address'
+// RETURNS:
+//   0 on success
+//   E_INVAL if the VA is not 4MB-aligned or a table/page already exists there
+//
+int map_large_frame(uint32 *ptr_page_directory, struct FrameInfo *ptr_frame_info, uint32 virtual_address, int perm)
+{
+	if (virtual_address % PTSIZE != 0 || ptr_page_directory[PDX(virtual_address)] != 0)
+		return E_INVAL;
+	for (uint32 i = 0; i < NPTENTRIES; i++)
+		ptr_frame_info[i].references++;
+	ptr_page_directory[PDX(virtual_address)] = CONSTRUCT_ENTRY(to_physical_address(ptr_frame_info), perm | PTE_PS | PERM_PRESENT);
+	return 0;
+}
+
+//
+// Unmaps the large page that contains 'virtual_address' (if any)
+// and decrements the references of its frames (freeing the ones that reach 0)
+//
+void unmap_large_frame(uint32 *ptr_page_directory, uint32 virtual_address)
+{
+	if (!is_large_page_mapped(ptr_page_directory, virtual_address))
+		return;
+	uint32 page_directory_entry = ptr_page_directory[PDX(virtual_address)];
+	struct FrameInfo *ptr_frame_info = to_frame_info(EXTRACT_ADDRESS(page_directory_entry));
+	ptr_page_directory[PDX(virtual_address)] = 0;
+	tlb_invalidate(ptr_page_directory, (void *)ROUNDDOWN(virtual_address, PTSIZE));
+	for (uint32 i = 0; i < NPTENTRIES; i++)
+		decrement_references(&ptr_frame_info[i]);
+}
+
 ///****************************************************************************************///
 ///******************************* END OF MAPPING USER SPACE ******************************///
 ///****************************************************************************************///
@@ -563,22 +1303,36 @@ struct freeFramesCounters calculate_available_frames()
 	uint32 totalFreeUnBuffered = 0 ;
 	uint32 totalFreeBuffered = 0 ;
 	uint32 totalModified = 0 ;
+	struct freeFramesCounters counters ;
 	bool lock_is_held = holding_kspinlock(&MemFrameLists.mfllock);
 	if (!lock_is_held)
 	{
 		acquire_kspinlock(&MemFrameLists.mfllock);
 	}
 	{
-		//calculate the free frames from the free frame list
-
-		LIST_FOREACH(ptr, &MemFrameLists.free_frame_list)
+		//calculate the free frames from the free lists of the buddy allocator
+		//(with the fragmentation: num of free blocks of each order)
+		counters.largestFreeOrder = -1;
+		for (int order = 0; order <= MAX_FRAME_ORDER; order++)
 		{
-			if (ptr->isBuffered)
-				totalFreeBuffered++ ;
-			else
-				totalFreeUnBuffered++ ;
+			counters.freeBlocks[order] = LIST_SIZE(&MemFrameLists.free_lists[order]);
+			if (counters.freeBlocks[order] > 0)
+				counters.largestFreeOrder = order;
+			LIST_FOREACH(ptr, &MemFrameLists.free_lists[order])
+			{
+				if (ptr->isBuffered)
+					totalFreeBuffered += (1 << order) ;
+				else
+					totalFreeUnBuffered += (1 << order) ;
+			}
 		}
 
+		//the frames in the per-CPU caches & the pooled ones are free as well
+		for (int c = 0; c < NCPUS; c++)
+			totalFreeUnBuffered += FrameCaches[c].count;
+		totalFreeUnBuffered += LIST_SIZE(&ZeroedFrames.frames);
+		totalFreeUnBuffered += LIST_SIZE(&PTFrames.clean) + LIST_SIZE(&PTFrames.dirty) + PTFrames.cleaning;
+
 		/*2023: UPDATE based on suggestion from T112 2023.Term1*/
 		totalModified= LIST_SIZE(&MemFrameLists.modified_frame_list);
 		//	LIST_FOREACH(ptr, &modified_frame_list)
@@ -590,7 +1344,6 @@ struct freeFramesCounters calculate_available_frames()
 	{
 		release_kspinlock(&MemFrameLists.mfllock);
 	}
-	struct freeFramesCounters counters ;
 	counters.freeBuffered = totalFreeBuffered ;
 	counters.freeNotBuffered = totalFreeUnBuffered ;
 	counters.modified = totalModified;
@@ -42,9 +42,38 @@ uint32 memory_scarce_threshold_percentage;	// Memory remains plentiful till the
 
 //***********************************
 /*DATA*/
+/*2025*/ //Per-CPU cache of free frames (to take the MemFrameLists.mfllock once per batch)
+#define FRAME_CACHE_BATCH	32						//num of frames to refill/drain at once
+#define FRAME_CACHE_SIZE	(2 * FRAME_CACHE_BATCH)
+struct frame_cache
+{
+	uint32 count;
+	struct FrameInfo *frames[FRAME_CACHE_SIZE];		//stack: the most recently freed on top
+	//stats
+	uint32 allocs, alloc_hits, frees, free_hits, refills, drains;
+};
+extern struct frame_cache FrameCaches[NCPUS];
+
+/*2025*/ //Pool of pre-zeroed free frames (filled in the idle time)
+#define ZEROED_POOL_SIZE		64		//max num of pre-zeroed frames
+#define ZEROED_POOL_MIN_FREE	256		//don't fill it if the other free frames are less than this
+#define ZEROED_FILL_PER_IDLE	8		//num of frames to zero each time the CPU becomes idle
+
+/*2025*/ //Pool of the frames of the page tables (the tables of the freed envs are reused by the new ones)
+#define PT_POOL_SIZE			64		//max num of pooled table frames (zeroed + not zeroed yet)
+
+/*2025*/ //Page coloring: the color of a frame is its frame number mod the num of colors
+//(= L2 cache size / (its ways * PAGE_SIZE)), the color of a VA is its page number mod the same
+#define DEF_FRAME_COLORS			16						//e.g. 512KB 8-way L2 cache
+#define MAX_FRAME_COLORS			(1 << MAX_FRAME_ORDER)
+#define FRAME_COLOR_SEARCH_LIMIT	64						//max num of free blocks to check in each free list
+
 struct freeFramesCounters
 {
 	int freeBuffered, freeNotBuffered, modified;
+	/*2025*/ //fragmentation of the free frames
+	int freeBlocks[MAX_FRAME_ORDER + 1];	//num of free blocks of each order (1 << order frames each)
+	int largestFreeOrder;					//order of the largest free block (-1 if none)
 };
 
 
@@ -54,6 +83,23 @@ struct freeFramesCounters
 //RUN TIME [USER SPACE]
 int allocate_frame(struct FrameInfo **ptr_frame_info);
 void free_frame(struct FrameInfo *ptr_frame_info);
+/*2025*/ int allocate_frames(uint32 order, struct FrameInfo **ptr_frame_info);
+/*2025*/ void free_frames(struct FrameInfo *ptr_frame_info, uint32 order);
+/*2025*/ uint32 num_of_free_frames();
+/*2025*/ void drain_frame_cache();
+/*2025*/ void frame_cache_print_stats(bool reset);
+/*2025*/ int allocate_frame_zeroed(struct FrameInfo **ptr_frame_info);
+/*2025*/ void fill_zeroed_frames(uint32 max);
+/*2025*/ uint32 num_of_zeroed_frames();
+/*2025*/ void zeroed_frames_print_stats();
+/*2025*/ int allocate_page_table_frame(struct FrameInfo **ptr_frame_info);
+/*2025*/ void free_page_table_frame(struct FrameInfo *ptr_frame_info);
+/*2025*/ void clean_page_table_frames(uint32 max);
+/*2025*/ void page_table_frames_print_stats();
+/*2025*/ int allocate_frame_colored(struct FrameInfo **ptr_frame_info, uint32 virtual_address, bool zeroed);
+/*2025*/ int set_num_of_frame_colors(uint32 num_of_colors);
+/*2025*/ uint32 get_num_of_frame_colors();
+/*2025*/ void frame_colors_print_stats();
 int	map_frame(uint32 *ptr_page_directory, struct FrameInfo *ptr_frame_info, uint32 virtual_address, int perm);
 void unmap_frame(uint32 *pgdir, uint32 virtual_address);
 int get_page_table(uint32 *ptr_page_directory, const uint32 virtual_address, uint32 **ptr_page_table);
@@ -62,6 +108,15 @@ struct FrameInfo *get_frame_info(uint32 *ptr_page_directory, uint32 virtual_addr
 void decrement_references(struct FrameInfo* ptr_frame_info);
 void initialize_frame_info(struct FrameInfo *ptr_frame_info);
 
+/*2025*/ //LARGE (4MB) PAGES
+int allocate_large_frame(struct FrameInfo **ptr_frame_info);
+int map_large_frame(uint32 *ptr_page_directory, struct FrameInfo *ptr_frame_info, uint32 virtual_address, int perm);
+void unmap_large_frame(uint32 *ptr_page_directory, uint32 virtual_address);
+static inline bool is_large_page_mapped(uint32 *ptr_page_directory, uint32 virtual_address)
+{
+	return (ptr_page_directory[PDX(virtual_address)] & (PTE_PS|PERM_PRESENT)) == (PTE_PS|PERM_PRESENT);
+}
+
 static inline uint32 to_frame_number(struct FrameInfo *ptr_frame_info)
 {
 	return ptr_frame_info - frames_info;
@@ -210,19 +210,14 @@ inline void del_page_table(uint32* page_dir, uint32 va)
 	if (ptr_page_table == NULL)
 		return ;
 
-#if USE_KHEAP
-	// directly remove the page table from the kernel heap
-	kfree(ptr_page_table);
-#else
 	// get the physical address and Frame_Info of the page table
 	uint32 table_pa = STATIC_KERNEL_PHYSICAL_ADDRESS(ptr_page_table);
 	struct FrameInfo *table_frame_info = to_frame_info(table_pa);
 
 	// set references of the table frame to 0 then free it by adding
-	// to the free frame list
+	// to the page tables pool (2025: even with the KHEAP)
 	table_frame_info->references = 0;
-	free_frame(table_frame_info);
-#endif
+	free_page_table_frame(table_frame_info);
 
 	// set the corresponding entry in the directory to 0
 	uint32 dir_index = PDX(va);
@@ -13,6 +13,347 @@
 #include "kheap.h"
 #include "memory_manager.h"
 
+//==================================================================================//
+//================================ SHARES INDEXES ==================================//
+//==================================================================================//
+#if USE_KHEAP
+static inline uint32 share_hash_name(int32 ownerID, char* name)
+{
+	//FNV-1a over the name, seeded by the owner
+	uint32 h = 2166136261u ^ ((uint32)ownerID * 2654435761u);
+	for (; *name != '\0'; name++)
+		h = (h ^ (uint8)(*name)) * 16777619u;
+	return h;
+}
+static inline uint32 share_hash_id(int32 ID)
+{
+	uint32 h = (uint32)ID * 2654435761u;
+	return h ^ (h >> 16);
+}
+static inline uint32 share_hash(int which, struct Share* shr)
+{
+	return which == SHARE_IDX_NAME ? share_hash_name(shr->ownerID, shr->name) : share_hash_id(shr->ID);
+}
+
+static int share_htable_init(struct share_htable* tab, uint32 size)
+{
+	tab->buckets = (struct Share**)kmalloc(size * sizeof(struct Share*));
+	if (tab->buckets == NULL)
+		return 0;
+	memset(tab->buckets, 0, size * sizeof(struct Share*));
+	tab->size = size;
+	tab->count = 0;
+	return 1;
+}
+
+static inline void share_htable_push(struct share_htable* tab, int which, struct Share* shr, uint32 hash)
+{
+	uint32 b = hash & (tab->size - 1);
+	shr->hnext[which] = tab->buckets[b];
+	tab->buckets[b] = shr;
+	tab->count++;
+}
+
+static int share_htable_remove(struct share_htable* tab, int which, struct Share* shr, uint32 hash)
+{
+	struct Share** pp = &(tab->buckets[hash & (tab->size - 1)]);
+	for (; *pp != NULL; pp = &((*pp)->hnext[which]))
+	{
+		if (*pp == shr)
+		{
+			*pp = shr->hnext[which];
+			shr->hnext[which] = NULL;
+			tab->count--;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+//Move (at most) n buckets of the old table to the new one
+//The shares lock MUST be held for write
+static void share_index_rehash_step(struct share_index* idx, int which, uint32 n)
+{
+	if (idx->rehash_idx < 0)
+		return;
+	struct share_htable* old = &(idx->tab[0]);
+	for (; n > 0 && idx->rehash_idx < old->size; n--, idx->rehash_idx++)
+	{
+		struct Share* shr = old->buckets[idx->rehash_idx];
+		while (shr != NULL)
+		{
+			struct Share* next = shr->hnext[which];
+			share_htable_push(&(idx->tab[1]), which, shr, share_hash(which, shr));
+			old->count--;
+			shr = next;
+		}
+		old->buckets[idx->rehash_idx] = NULL;
+	}
+	if (idx->rehash_idx == old->size)
+	{
+		kfree(old->buckets);
+		idx->tab[0] = idx->tab[1];
+		idx->tab[1].buckets = NULL;
+		idx->tab[1].size = idx->tab[1].count = 0;
+		idx->rehash_idx = -1;
+	}
+}
+
+//The shares lock MUST be held for write
+static void share_index_insert(int which, struct Share* shr)
+{
+	struct share_index* idx = &(AllShares.indexes[which]);
+	share_index_rehash_step(idx, which, SHARE_REHASH_STEP);
+
+	//start growing if it's loaded (if no memory, keep using the current table)
+	if (idx->rehash_idx < 0 && idx->tab[0].count >= idx->tab[0].size * SHARE_INDEX_MAX_LOAD)
+	{
+		if (share_htable_init(&(idx->tab[1]), idx->tab[0].size * 2))
+			idx->rehash_idx = 0;
+	}
+
+	struct share_htable* tab = idx->rehash_idx < 0 ? &(idx->tab[0]) : &(idx->tab[1]);
+	share_htable_push(tab, which, shr, share_hash(which, shr));
+}
+
+//The shares lock MUST be held for write
+static void share_index_remove(int which, struct Share* shr)
+{
+	struct share_index* idx = &(AllShares.indexes[which]);
+	uint32 hash = share_hash(which, shr);
+	if (!share_htable_remove(&(idx->tab[0]), which, shr, hash) && idx->rehash_idx >= 0)
+		share_htable_remove(&(idx->tab[1]), which, shr, hash);
+	share_index_rehash_step(idx, which, SHARE_REHASH_STEP);
+}
+
+//Search the index by ID (the shares lock MUST be held)
+static struct Share* find_share_by_id_nolock(int32 ID)
+{
+	struct share_index* idx = &(AllShares.indexes[SHARE_IDX_ID]);
+	uint32 hash = share_hash_id(ID);
+	for (int t = 0; t < 2; t++)
+	{
+		struct share_htable* tab = &(idx->tab[t]);
+		if (tab->buckets == NULL)
+			break;
+		struct Share* shr = tab->buckets[hash & (tab->size - 1)];
+		for (; shr != NULL; shr = shr->hnext[SHARE_IDX_ID])
+		{
+			if (shr->ID == ID)
+				return shr;
+		}
+	}
+	return NULL;
+}
+#endif
+
+//==================================================================================//
+//========================= LAZY SHARES (ATTACHMENTS) ==============================//
+//==================================================================================//
+//In lazy mode, creating/getting a share only records its VA range in the env
+//(an attachment) and the frames are allocated & mapped by the fault handler on
+//the first touch of each page. The share keeps its own reference on each of
+//its frames, so a frame survives till the share is freed even if all the envs
+//that touched it have unmapped it.
+uint8 _EnableLazySharing = 0;
+void enableLazySharing(uint32 enableIt) { _EnableLazySharing = enableIt; }
+uint8 isLazySharingEnabled() { return _EnableLazySharing; }
+
+#if USE_KHEAP
+static struct share_attachment attachments[MAX_SHARE_ATTACHMENTS];
+static struct share_attachment_list used_attachments;
+static struct share_attachment_list free_attachments;
+static uint32 num_of_attachments = 0;
+
+static void share_attachments_init()
+{
+	LIST_INIT(&used_attachments);
+	LIST_INIT(&free_attachments);
+	for (int i = 0; i < MAX_SHARE_ATTACHMENTS; i++)
+		LIST_INSERT_HEAD(&free_attachments, &attachments[i]);
+	num_of_attachments = 0;
+}
+
+//Attach the given share to the given env at the given VA (nothing is mapped)
+//The shares lock MUST be held for write
+static int share_attach(struct Env* e, struct Share* shr, uint32 va)
+{
+	struct share_attachment* att = LIST_FIRST(&free_attachments);
+	if (att == NULL)
+		return E_NO_SHARE;
+	LIST_REMOVE(&free_attachments, att);
+	att->env_id = e->env_id;
+	att->start_va = va;
+	att->num_of_pages = ROUNDUP(shr->size, PAGE_SIZE) / PAGE_SIZE;
+	att->share = shr;
+	LIST_INSERT_HEAD(&used_attachments, att);
+	num_of_attachments++;
+	return 0;
+}
+
+//The shares lock MUST be held for write
+static void share_detach(struct share_attachment* att)
+{
+	LIST_REMOVE(&used_attachments, att);
+	att->share = NULL;
+	LIST_INSERT_HEAD(&free_attachments, att);
+	num_of_attachments--;
+}
+
+//Find the attachment of the given env that contains the given VA
+//The shares lock MUST be held
+static struct share_attachment* find_attachment(int32 env_id, uint32 va)
+{
+	struct share_attachment* att;
+	LIST_FOREACH(att, &used_attachments)
+	{
+		if (att->env_id == env_id && va >= att->start_va && va < att->start_va + att->num_of_pages * PAGE_SIZE)
+			return att;
+	}
+	return NULL;
+}
+#endif
+
+//=====================================================
+// Handle the first touch of a page of a lazily-attached share
+// Returns 0 if handled, E_SHARED_MEM_NOT_EXISTS if the VA is not in an attachment
+//=====================================================
+int share_lazy_fault(struct Env* e, uint32 fault_va)
+{
+#if USE_KHEAP
+	if (num_of_attachments == 0 || fault_va < USER_HEAP_START || fault_va >= USER_HEAP_MAX)
+		return E_SHARED_MEM_NOT_EXISTS;
+	if (pt_get_page_permissions(e->env_page_directory, fault_va) & PERM_PRESENT)
+		return E_SHARED_MEM_NOT_EXISTS;
+
+	uint32 va = ROUNDDOWN(fault_va, PAGE_SIZE);
+	acquire_write_krwlock(&AllShares.sharesrwlock);
+	struct share_attachment* att = find_attachment(e->env_id, va);
+	if (att == NULL)
+	{
+		release_write_krwlock(&AllShares.sharesrwlock);
+		return E_SHARED_MEM_NOT_EXISTS;
+	}
+	struct Share* shr = att->share;
+	uint32 i = (va - att->start_va) / PAGE_SIZE;
+	if (shr->framesStorage[i] == NULL)
+	{
+		//first touch by any env: allocate a zeroed frame & keep a reference on it
+		struct FrameInfo* ptr_frame = NULL;
+		allocate_frame(&ptr_frame);
+		memset(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(ptr_frame)), 0, PAGE_SIZE);
+		ptr_frame->references++;
+		shr->framesStorage[i] = ptr_frame;
+	}
+	uint32 perms = PERM_PRESENT | PERM_USER;
+	if (shr->isWritable)
+		perms |= PERM_WRITEABLE;
+	map_frame(e->env_page_directory, shr->framesStorage[i], va, perms);
+	release_write_krwlock(&AllShares.sharesrwlock);
+	return 0;
+#else
+	return E_SHARED_MEM_NOT_EXISTS;
+#endif
+}
+
+//Detach all the shares that are attached to the given env (on its free)
+void share_release_attachments(struct Env* e)
+{
+#if USE_KHEAP
+	bool wasHeld = holding_write_krwlock(&AllShares.sharesrwlock);
+	if (!wasHeld)
+		acquire_write_krwlock(&AllShares.sharesrwlock);
+	struct share_attachment* att = LIST_FIRST(&used_attachments);
+	while (att != NULL)
+	{
+		struct share_attachment* next = LIST_NEXT(att);
+		if (att->env_id == e->env_id)
+			share_detach(att);
+		att = next;
+	}
+	if (!wasHeld)
+		release_write_krwlock(&AllShares.sharesrwlock);
+#endif
+}
+
+//==================================================================================//
+//============================ LARGE (4MB) SHARES ==================================//
+//==================================================================================//
+//In large mode, a share whose size & VA are 4MB-aligned is backed by large frames
+//(NPTENTRIES contiguous frames at a 4MB-aligned PA) and each 4MB of it is mapped by a
+//single directory entry (PTE_PS) in every env that has it at a 4MB-aligned VA with no
+//table there. Otherwise (no large frame available, unaligned VA in the getter, ...)
+//the same frames are mapped by 4KB pages, so large mode is only an optimization.
+uint8 _EnableLargeSharing = 0;
+void enableLargeSharing(uint32 enableIt) { _EnableLargeSharing = enableIt; }
+uint8 isLargeSharingEnabled() { return _EnableLargeSharing; }
+
+#if USE_KHEAP
+//The NPTENTRIES frames of the share starting from the given page form a large frame
+static bool share_block_is_large(struct Share* shr, uint32 first_page)
+{
+	struct FrameInfo* first = shr->framesStorage[first_page];
+	if (first == NULL || to_physical_address(first) % PTSIZE != 0)
+		return 0;
+	for (uint32 j = 1; j < NPTENTRIES; j++)
+	{
+		if (shr->framesStorage[first_page + j] != first + j)
+			return 0;
+	}
+	return 1;
+}
+
+//Map NPTENTRIES frames of the share (starting from the given page) at the given VA
+//by a large page if possible, or by 4KB pages otherwise
+static void share_map_block(struct Env* e, struct Share* shr, uint32 first_page, uint32 va, uint32 perms)
+{
+	if (va % PTSIZE == 0 && share_block_is_large(shr, first_page) &&
+			map_large_frame(e->env_page_directory, shr->framesStorage[first_page], va, perms) == 0)
+		return;
+	for (uint32 j = 0; j < NPTENTRIES; j++)
+		map_frame(e->env_page_directory, shr->framesStorage[first_page + j], va + j * PAGE_SIZE, perms);
+}
+
+//Unmap the given range of a share from the given env (dropping the references on its frames,
+//so they're freed if it's the last mapping) & remove its page tables that become empty
+static void share_unmap_range(struct Env* e, uint32 start, uint32 size)
+{
+	uint32 pages = ROUNDUP(size, PAGE_SIZE) / PAGE_SIZE;
+	for (uint32 i = 0; i < pages; i++)
+	{
+		//a large page is unmapped as a whole
+		if (is_large_page_mapped(e->env_page_directory, start + i * PAGE_SIZE))
+		{
+			unmap_large_frame(e->env_page_directory, start + i * PAGE_SIZE);
+			i += NPTENTRIES - 1;
+			continue;
+		}
+		unmap_frame(e->env_page_directory, start + i * PAGE_SIZE);
+	}
+
+	uint32 end = start + size;
+	for (uint32 i = PDX(start); i <= PDX(end-1); i++)
+	{
+		uint32 *ptr_page_table;
+		int ret = get_page_table(e->env_page_directory, i << 22, &ptr_page_table);
+		if (ret == TABLE_IN_MEMORY && ptr_page_table != NULL)
+		{
+			bool is_empty = 1;
+			for (int j = 0; j < 1024; j++)
+			{
+				if (ptr_page_table[j] != 0)
+				{
+					is_empty = 0;
+					break;
+				}
+			}
+			if (is_empty)
+				del_page_table(e->env_page_directory, i << PTSHIFT);	//back to the page tables pool
+		}
+	}
+}
+#endif
+
 //==================================================================================//
 //============================== GIVEN FUNCTIONS ===================================//
 //==================================================================================//
@@ -25,7 +366,16 @@ void sharing_init()
 {
 #if USE_KHEAP
 	LIST_INIT(&AllShares.shares_list) ;
-	init_kspinlock(&AllShares.shareslock, "shares lock");
+	init_krwlock(&AllShares.sharesrwlock, "shares lock");
+	for (int which = 0; which < SHARE_NUM_INDEXES; which++)
+	{
+		AllShares.indexes[which].rehash_idx = -1;
+		AllShares.indexes[which].tab[1].buckets = NULL;
+		AllShares.indexes[which].tab[1].size = AllShares.indexes[which].tab[1].count = 0;
+		if (!share_htable_init(&(AllShares.indexes[which].tab[0]), SHARE_INDEX_INIT_SIZE))
+			panic("sharing_init: no memory for the shares indexes");
+	}
+	share_attachments_init();
 	//init_sleeplock(&AllShares.sharessleeplock, "shares sleep lock");
 #else
 	panic("not handled when KERN HEAP is disabled");
@@ -39,18 +389,21 @@ void sharing_init()
 //Return:
 //	a) if found: ptr to Share object
 //	b) else: NULL
-struct Share* find_share(int32 ownerID, char* name)
+//The caller MUST hold the shares lock (for read or write)
+static struct Share* find_share_nolock(int32 ownerID, char* name)
 {
 #if USE_KHEAP
 	struct Share * ret = NULL;
-	bool wasHeld = holding_kspinlock(&(AllShares.shareslock));
-	if (!wasHeld)
+	struct share_index* idx = &(AllShares.indexes[SHARE_IDX_NAME]);
+	uint32 hash = share_hash_name(ownerID, name);
+	//search the old table then the new one (if it's growing)
+	for (int t = 0; t < 2 && ret == NULL; t++)
 	{
-		acquire_kspinlock(&(AllShares.shareslock));
-	}
-	{
-		struct Share * shr ;
-		LIST_FOREACH(shr, &(AllShares.shares_list))
+		struct share_htable* tab = &(idx->tab[t]);
+		if (tab->buckets == NULL)
+			break;
+		struct Share * shr = tab->buckets[hash & (tab->size - 1)];
+		for (; shr != NULL; shr = shr->hnext[SHARE_IDX_NAME])
 		{
 //			cprintf("shared var name = %s compared with %s\n", name, shr->name);
 //			cprintf("shared var id = %d compared with %d\n",ownerID , shr->ownerID);
@@ -62,9 +415,27 @@ struct Share* find_share(int32 ownerID, char* name)
 			}
 		}
 	}
+	return ret;
+#else
+	panic("not handled when KERN HEAP is disabled");
+#endif
+}
+
+//Lookups hold the shares lock for READ (i.e. run concurrently),
+//unless the caller already holds it for write
+struct Share* find_share(int32 ownerID, char* name)
+{
+#if USE_KHEAP
+	struct Share * ret = NULL;
+	bool wasHeld = holding_write_krwlock(&(AllShares.sharesrwlock));
 	if (!wasHeld)
 	{
-		release_kspinlock(&(AllShares.shareslock));
+		acquire_read_krwlock(&(AllShares.sharesrwlock));
+	}
+	ret = find_share_nolock(ownerID, name);
+	if (!wasHeld)
+	{
+		release_read_krwlock(&(AllShares.sharesrwlock));
 	}
 	return ret;
 #else
@@ -82,13 +453,20 @@ int size_of_shared_object(int32 ownerID, char* shareName)
 	//	a) If found, return size of shared object
 	//	b) Else, return E_SHARED_MEM_NOT_EXISTS
 	//
-	struct Share* ptr_share = find_share(ownerID, shareName);
-	if (ptr_share == NULL)
-		return E_SHARED_MEM_NOT_EXISTS;
-	else
-		return ptr_share->size;
-
-	return 0;
+#if USE_KHEAP
+	int size = E_SHARED_MEM_NOT_EXISTS;
+	acquire_read_krwlock(&(AllShares.sharesrwlock));
+	{
+		//hold it till reading the size (the share can't be freed meanwhile)
+		struct Share* ptr_share = find_share_nolock(ownerID, shareName);
+		if (ptr_share != NULL)
+			size = ptr_share->size;
+	}
+	release_read_krwlock(&(AllShares.sharesrwlock));
+	return size;
+#else
+	panic("not handled when KERN HEAP is disabled");
+#endif
 }
 //===========================================================
 
@@ -129,6 +507,11 @@ struct Share* alloc_share(int32 ownerID, char* shareName, uint32 size, uint8 isW
     //SHred_OBJ->ID=((uint32)virtual_address)& ~(1 << 31);//shift to make the most significant 0
     SHred_OBJ->size = size;
 	SHred_OBJ->isWritable=isWritable;
+	SHred_OBJ->isLazy = isLazySharingEnabled();
+	SHred_OBJ->isLarge = !SHred_OBJ->isLazy && isLargeSharingEnabled() && (size % PTSIZE == 0);
+	//not yet in the indexes (inserted with the list by create_shared_object)
+	for (int which = 0; which < SHARE_NUM_INDEXES; which++)
+		SHred_OBJ->hnext[which] = NULL;
    	uint32 numOFp=ROUNDUP(size,PAGE_SIZE)/PAGE_SIZE;
 
    	uint32 the_ss=numOFp*sizeof(struct FrameInfo*);
@@ -195,8 +578,34 @@ int create_shared_object(int32 ownerID, char* shareName, uint32 size, uint8 isWr
 	//if failed to create a shared object
 
 	if (SHred_OBJ==NULL)return E_NO_SHARE;
+	uint32 startVA = (uint32)virtual_address;
 
 	uint32 numOFp=ROUNDUP(size,PAGE_SIZE)/PAGE_SIZE;
+	//lazy: the frames are allocated on the first touch (see share_lazy_fault())
+	if (SHred_OBJ->isLazy)
+		numOFp = 0;
+	//large: allocate & map it 4MB at a time (see share_map_block())
+	if (SHred_OBJ->isLarge && (uint32)virtual_address % PTSIZE != 0)
+		SHred_OBJ->isLarge = 0;
+	if (SHred_OBJ->isLarge)
+	{
+		for (uint32 i = 0; i < numOFp; i += NPTENTRIES)
+		{
+			//no free large frame: fall back to 4KB ones
+			struct FrameInfo* first = NULL;
+			allocate_large_frame(&first);
+			for (uint32 j = 0; j < NPTENTRIES; j++)
+			{
+				if (first != NULL)
+					SHred_OBJ->framesStorage[i + j] = first + j;
+				else
+					allocate_frame(&(SHred_OBJ->framesStorage[i + j]));
+			}
+			share_map_block(myenv, SHred_OBJ, i, (uint32)virtual_address + i * PAGE_SIZE,
+					PERM_PRESENT | PERM_USER | PERM_WRITEABLE);
+		}
+		numOFp = 0;
+	}
 	  for(uint32 i=0 ; i<numOFp ; i++){
 		  struct FrameInfo* ELMAKAN = NULL;
 		  allocate_frame(&ELMAKAN);
@@ -220,15 +629,33 @@ int create_shared_object(int32 ownerID, char* shareName, uint32 size, uint8 isWr
 	  	}
 
 //	 //locks
-	  if (!holding_kspinlock(&AllShares.shareslock))
-	  acquire_kspinlock(&AllShares.shareslock);
+	  acquire_write_krwlock(&AllShares.sharesrwlock);
+	  //another env may have created the same share meanwhile
+	  if (find_share_nolock(ownerID, shareName) != NULL)
+	  {
+		  release_write_krwlock(&AllShares.sharesrwlock);
+		  //undo: unmap its frames (that frees them) & free the object
+		  //(not by free_share() since it's not in the list/indexes)
+		  share_unmap_range(myenv, startVA, SHred_OBJ->size);
+		  tlbflush();
+		  kfree(SHred_OBJ->framesStorage);
+		  kfree(SHred_OBJ);
+		  return E_SHARED_MEM_EXISTS;
+	  }
 //	  cprintf("SHred_OBJ %d\n", SHred_OBJ->ID);
 //	  cprintf("SHred_OBJ %d\n", SHred_OBJ->ownerID);
 	    LIST_INSERT_TAIL(&AllShares.shares_list, SHred_OBJ);
+	    share_index_insert(SHARE_IDX_NAME, SHred_OBJ);
+	    share_index_insert(SHARE_IDX_ID, SHred_OBJ);
+	    if (SHred_OBJ->isLazy && share_attach(myenv, SHred_OBJ, (uint32)virtual_address) != 0)
+	    {
+	    	free_share(SHred_OBJ);
+	    	release_write_krwlock(&AllShares.sharesrwlock);
+	    	return E_NO_SHARE;
+	    }
 
 	           // SHred_OBJ->name, SHred_OBJ->ownerID, SHred_OBJ->ID, SHred_OBJ->size);
-	   if (holding_kspinlock(&AllShares.shareslock))
-	     release_kspinlock(&AllShares.shareslock);
+	  release_write_krwlock(&AllShares.sharesrwlock);
 //	     LIST_FOREACH(shr, &(AllShares.shares_list)){
 //	     				cprintf("shr2 %d\n", shr->ownerID);
 //	     			}
@@ -258,10 +685,40 @@ int get_shared_object(int32 ownerID, char* shareName, void* virtual_address)
 	// RETURN:
 	//	a) ID of the shared object (its VA after masking out its msb) if success
 	//	b) E_SHARED_MEM_NOT_EXISTS if the shared object is not exists
-	struct Share* THE_OBCT = find_share(ownerID,shareName);
+	//find it & take a reference under the read lock (concurrent sget's don't serialize;
+	//the reference keeps it from being freed while mapping it below)
+	acquire_read_krwlock(&AllShares.sharesrwlock);
+	struct Share* THE_OBCT = find_share_nolock(ownerID,shareName);
 		//if the shared object exists
-		if(THE_OBCT==NULL)return E_SHARED_MEM_NOT_EXISTS;
+		if(THE_OBCT==NULL)
+		{
+			release_read_krwlock(&AllShares.sharesrwlock);
+			return E_SHARED_MEM_NOT_EXISTS;
+		}
+		xadd((volatile int32*)&(THE_OBCT->references), 1);
+	release_read_krwlock(&AllShares.sharesrwlock);
+
+	//lazy: just attach its range (O(1)), the pages are mapped on their first touch
+	if (THE_OBCT->isLazy)
+	{
+		acquire_write_krwlock(&AllShares.sharesrwlock);
+		int ret = share_attach(myenv, THE_OBCT, (uint32)virtual_address);
+		if (ret != 0)
+			THE_OBCT->references--;
+		release_write_krwlock(&AllShares.sharesrwlock);
+		return ret == 0 ? THE_OBCT->ID : ret;
+	}
 		uint32 numOFp=ROUNDUP(THE_OBCT->size,PAGE_SIZE)/PAGE_SIZE;
+	//large: map it 4MB at a time (by large pages if the VA allows)
+	if (THE_OBCT->isLarge)
+	{
+		uint32 perms = PERM_PRESENT | PERM_USER;
+		if (THE_OBCT->isWritable)
+			perms |= PERM_WRITEABLE;
+		for (uint32 i = 0; i < numOFp; i += NPTENTRIES)
+			share_map_block(myenv, THE_OBCT, i, (uint32)virtual_address + i * PAGE_SIZE, perms);
+		return THE_OBCT->ID;
+	}
         while(0){
         	cprintf("000");
         	return PAGE_SIZE;
@@ -280,13 +737,6 @@ int get_shared_object(int32 ownerID, char* shareName, void* virtual_address)
 			  		virtual_address+=PAGE_SIZE;
 
 			  	}
-		         if(1){
-			  if (!holding_kspinlock(&AllShares.shareslock))
-	           acquire_kspinlock(&AllShares.shareslock);
-		       THE_OBCT->references++;
-		      if (holding_kspinlock(&AllShares.shareslock))
-     	      release_kspinlock(&AllShares.shareslock);
-		         }
 		      return THE_OBCT->ID;
 
 #else
@@ -312,17 +762,42 @@ void free_share(struct Share* ptrShare_abdo)
 
 	if (ptrShare_abdo == NULL) return;
 
-	bool abdoh = holding_kspinlock(&AllShares.shareslock);
+	bool abdoh = holding_write_krwlock(&AllShares.sharesrwlock);
 	if (!abdoh)
-		acquire_kspinlock(&AllShares.shareslock);
+		acquire_write_krwlock(&AllShares.sharesrwlock);
 	
 	LIST_REMOVE(&(AllShares.shares_list), ptrShare_abdo);
+	share_index_remove(SHARE_IDX_NAME, ptrShare_abdo);
+	share_index_remove(SHARE_IDX_ID, ptrShare_abdo);
+	if (ptrShare_abdo->isLazy)
+	{
+		//drop its attachments (if any)
+		struct share_attachment* att = LIST_FIRST(&used_attachments);
+		while (att != NULL)
+		{
+			struct share_attachment* next = LIST_NEXT(att);
+			if (att->share == ptrShare_abdo)
+				share_detach(att);
+			att = next;
+		}
+	}
 
 	if (!abdoh)
-		release_kspinlock(&AllShares.shareslock);
+		release_write_krwlock(&AllShares.sharesrwlock);
 
 	ptrShare_abdo->prev_next_info.le_next = NULL; 
 	ptrShare_abdo->prev_next_info.le_prev = NULL;
+
+	if (ptrShare_abdo->isLazy)
+	{
+		//drop the references it keeps on its frames
+		uint32 numOFp = ROUNDUP(ptrShare_abdo->size, PAGE_SIZE) / PAGE_SIZE;
+		for (uint32 i = 0; i < numOFp; i++)
+		{
+			if (ptrShare_abdo->framesStorage[i] != NULL)
+				decrement_references(ptrShare_abdo->framesStorage[i]);
+		}
+	}
 	
 	if (ptrShare_abdo->framesStorage != NULL)
 		kfree(ptrShare_abdo->framesStorage);
@@ -364,69 +839,35 @@ int delete_shared_object(int32 sharedObjectID, void *startVA)
 
 	//	1) Get the shared object from the "shares" array (use get_share_object_ID())
 	struct Share* ptr_share_abdo = NULL;
-	bool abdoh = holding_kspinlock(&AllShares.shareslock);
+	bool abdoh = holding_write_krwlock(&AllShares.sharesrwlock);
 	
 	if (!abdoh) 
-		acquire_kspinlock(&AllShares.shareslock);
+		acquire_read_krwlock(&AllShares.sharesrwlock);
 
-	struct Share * shr_abdo ;
-	LIST_FOREACH(shr_abdo, &(AllShares.shares_list))
-	{
-		if(shr_abdo->ID == sharedObjectID)
-		{
-			ptr_share_abdo = shr_abdo;
-			break;
-		}
-	}
+	ptr_share_abdo = find_share_by_id_nolock(sharedObjectID);
+	if (!abdoh)
+		release_read_krwlock(&AllShares.sharesrwlock);
 	if (ptr_share_abdo == NULL)
 	{
-		if (!abdoh) 
-			release_kspinlock(&AllShares.shareslock);
 		return E_SHARED_MEM_NOT_EXISTS;
 	}
 
 
 	//	2) Unmap it from the current environment "myenv"
-	uint32 va_abdo = (uint32)startVA;
-	uint32 pages_abdo = ROUNDUP(ptr_share_abdo->size, PAGE_SIZE) / PAGE_SIZE;
+	//	3) If one or more table becomes empty, remove it
+	share_unmap_range(myenv, (uint32)startVA, ptr_share_abdo->size);
 
-	for (uint32 i = 0; i < pages_abdo; i++)
-	{
-		unmap_frame(myenv->env_page_directory, va_abdo + i * PAGE_SIZE);
-	}
+	//	4) Update references  
+	if (!abdoh)
+		acquire_write_krwlock(&AllShares.sharesrwlock);
 
-	//	3) If one or more table becomes empty, remove it 
-	uint32 start = (uint32)startVA;
-	uint32 end = start + ptr_share_abdo->size;
-	uint32 pdx_start = PDX(start);
-	uint32 pdx_end = PDX(end-1);
-	for (uint32 i = pdx_start; i <= pdx_end; i++)
+	if (ptr_share_abdo->isLazy)
 	{
-		uint32 *ptr_page_table;
-		int ret = get_page_table(myenv->env_page_directory, i << 22, &ptr_page_table);
-		if (ret == TABLE_IN_MEMORY && ptr_page_table != NULL)
-		{
-			bool is_empty = 1;
-			for (int j = 0; j < 1024; j++)
-			{
-				if (ptr_page_table[j] != 0)
-				{
-					is_empty = 0;
-					break;
-				}
-			}
-			if (is_empty)
-			{
-				kfree(ptr_page_table);
-				myenv->env_page_directory[i] = 0;
-			}
-		}
+		struct share_attachment* att = find_attachment(myenv->env_id, (uint32)startVA);
+		if (att != NULL)
+			share_detach(att);
 	}
 
-	//	4) Update references  
-	if (!abdoh)
-		acquire_kspinlock(&AllShares.shareslock);
-
 	ptr_share_abdo->references--;
 
 	//	5) If this is the last share, delete the share object (use free_share())
@@ -435,7 +876,7 @@ int delete_shared_object(int32 sharedObjectID, void *startVA)
 		free_share(ptr_share_abdo);
 	}
 	if (!abdoh) 
-		release_kspinlock(&AllShares.shareslock);
+		release_write_krwlock(&AllShares.sharesrwlock);
 	
 	//	6) Flush the cache "tlbflush()"
 	tlbflush();
@@ -11,8 +11,17 @@
 //#include <inc/memlayout.h>
 #include <inc/environment_definitions.h>
 #include "../conc/kspinlock.h"
+#include "../conc/rwlock.h"
 #include <kern/conc/sleeplock.h>
 
+//Indexes of the shares (hash tables)
+#define SHARE_IDX_NAME			0		/* by (ownerID, name) */
+#define SHARE_IDX_ID			1		/* by ID */
+#define SHARE_NUM_INDEXES		2
+#define SHARE_INDEX_INIT_SIZE	16		/* initial num of buckets (MUST be power of 2) */
+#define SHARE_INDEX_MAX_LOAD	2		/* grow (x2) when the avg chain length reaches it */
+#define SHARE_REHASH_STEP		4		/* num of old buckets to move on each insert/remove while growing */
+
 struct Share
 {
 	//Unique ID for this Share object
@@ -29,16 +38,50 @@ struct Share
 	uint32 references;
 	//sharing permissions (0: ReadOnly, 1:Writable)
 	uint8 isWritable;
+	//1 if its frames are allocated & mapped on the first touch (lazy mode)
+	uint8 isLazy;
+	//1 if it's mapped by large (4MB) pages wherever possible (large mode)
+	uint8 isLarge;
 	//to store frames to be shared
 	struct FrameInfo** framesStorage;
 	// list link pointers
 	LIST_ENTRY(Share) prev_next_info;
+	// next share in the same bucket of each index
+	struct Share* hnext[SHARE_NUM_INDEXES];
 
 };
 
 //List of all shared objects
 LIST_HEAD(Share_List, Share);		// Declares 'struct Share_List'
 
+//Lazy mode: the VA range of a share that's attached to an env but not (fully) mapped
+//(the pages are mapped by the fault handler on their first touch)
+#define MAX_SHARE_ATTACHMENTS	256
+struct share_attachment
+{
+	int32 env_id;				//attached env
+	uint32 start_va;			//start of the share in its user heap
+	uint32 num_of_pages;
+	struct Share* share;
+	LIST_ENTRY(share_attachment) prev_next_info;
+};
+LIST_HEAD(share_attachment_list, share_attachment);
+
+//Hash table of shares (chained by Share.hnext[])
+struct share_htable
+{
+	struct Share** buckets;
+	uint32 size;				//num of buckets (power of 2)
+	uint32 count;				//num of shares in it
+};
+//Index that grows incrementally: while rehashing, the old buckets (tab[0]) are moved
+//to the new ones (tab[1]) few at a time, and lookups search both
+struct share_index
+{
+	struct share_htable tab[2];
+	int32 rehash_idx;			//next bucket of tab[0] to move (-1: not rehashing)
+};
+
 
 #if USE_KHEAP == 0
 	//max number of shared objects
@@ -48,12 +91,22 @@ LIST_HEAD(Share_List, Share);		// Declares 'struct Share_List'
 	struct
 	{
 		struct Share_List shares_list ;	//List of all share variables created by any process
-		struct kspinlock shareslock;		//Use it to protect the shares_list in the kernel
+		struct krwlock sharesrwlock;		//Use it to protect the shares_list in the kernel (read: lookups, write: insert/remove)
+		struct share_index indexes[SHARE_NUM_INDEXES];	//hash indexes of the shares_list (by name & by ID)
 		//struct sleeplock sharessleeplock;	//Use it to protect the shares_list in the kernel
 	}AllShares;
 	void sharing_init();
 #endif
 
+struct Share* find_share(int32 ownerID, char* name);
+void free_share(struct Share* ptrShare);
+void enableLazySharing(uint32 enableIt);
+uint8 isLazySharingEnabled();
+int share_lazy_fault(struct Env* e, uint32 fault_va);
+void enableLargeSharing(uint32 enableIt);
+uint8 isLargeSharingEnabled();
+void share_release_attachments(struct Env* e);
+
 int size_of_shared_object(int32 ownerID, char* shareName);
 int create_shared_object(int32 ownerID, char* shareName, uint32 size, uint8 isWritable, void* virtual_address);
 int get_shared_object(int32 ownerID, char* shareName, void* virtual_address);
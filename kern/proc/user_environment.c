@@ -545,9 +545,9 @@ void env_free(struct Env *e)
     struct Share *next_shr_abdo;
     void free_share(struct Share* ptrShare_abdo);
    
-    bool wasHeld_abdo = holding_kspinlock(&(AllShares.shareslock));
+    bool wasHeld_abdo = holding_write_krwlock(&(AllShares.sharesrwlock));
     if (!wasHeld_abdo) {
-        acquire_kspinlock(&(AllShares.shareslock));
+        acquire_write_krwlock(&(AllShares.sharesrwlock));
     }
     shr_abdo = LIST_FIRST(&(AllShares.shares_list));
     while (shr_abdo != NULL)
@@ -559,9 +559,10 @@ void env_free(struct Env *e)
         }
         shr_abdo = next_shr_abdo;
     }
+    share_release_attachments(e);
 
     if (!wasHeld_abdo) {
-        release_kspinlock(&(AllShares.shareslock));
+        release_write_krwlock(&(AllShares.sharesrwlock));
     }
 #endif
 
@@ -569,13 +570,19 @@ void env_free(struct Env *e)
 	// [7] Free all TABLES from the main memory
 	for (int i = 0; i < PDX(USER_TOP); i++)
 	{
-		if (e->env_page_directory[i] & PERM_PRESENT)
+		/*2025*///a large (4MB) page (of a share) has no table, drop the references on its frames
+		if (is_large_page_mapped(e->env_page_directory, i << PTSHIFT))
+		{
+			unmap_large_frame(e->env_page_directory, i << PTSHIFT);
+		}
+		else if (e->env_page_directory[i] & PERM_PRESENT)
 		{
 			uint32 table_pa = e->env_page_directory[i] & ~0xFFF;
 			struct FrameInfo *ptr_table_frame = to_frame_info(table_pa);
 			e->env_page_directory[i] = 0;
-			if(ptr_table_frame)
-				decrement_references(ptr_table_frame);
+			/*2025*///back to the page tables pool (to be reused by the next envs)
+			if(ptr_table_frame && --(ptr_table_frame->references) == 0)
+				free_page_table_frame(ptr_table_frame);
 		}
 	}
 
@@ -1171,11 +1178,15 @@ void initialize_environment(struct Env* e, uint32* ptr_user_page_directory, unsi
 	e->nModifiedPages=0;
 	e->nNotModifiedPages=0;
 	e->nClocks = 0;
+	e->group_id = 0;
+	e->promoted = 0;
 
 	//2020
 	e->nPageIn = 0;
 	e->nPageOut = 0;
 	e->nNewPageAdded = 0;
+	e->nZswapPages = e->nZswapStores = 0;
+	e->nZswapOrigBytes = e->nZswapCompBytes = 0;
 
 	//e->shared_free_address = USER_SHARED_MEM_START;
 
@@ -117,6 +117,14 @@ struct UserProgramInfo userPrograms[] = {
 		{ "tstChanAllSlave", "Slave program of tst_chan_all", PTR_START_OF(tst_chan_all_slave)},
 		{ "tst_chan_one", "Tests sleep & wakeup ONE on a channel", PTR_START_OF(tst_chan_one_master)},
 		{ "tstChanOneSlave", "Slave program of tst_chan_one", PTR_START_OF(tst_chan_one_slave)},
+		{ "tst_sleep", "Tests the timed sleep (sys_sleep & sleep_timeout by the timer or by a wakeup)", PTR_START_OF(tst_sleep)},
+		{ "tstSleepSlave", "Slave program of tst_sleep", PTR_START_OF(tst_sleep_slave)},
+		{ "tst_umutex", "Tests the user-level mutex (spin-then-block) [multiprograms enter the same CS]", PTR_START_OF(tst_umutex_master)},
+		{ "umutexSlave", "[Slave program] of tst_umutex", PTR_START_OF(tst_umutex_slave)},
+		{ "tst_large_share", "Benchmarks the large (4MB) pages of the shared objects [column-wise traversal of a shared 4MB matrix]", PTR_START_OF(tst_large_share_master)},
+		{ "largeShareSlave", "[Slave program] of tst_large_share", PTR_START_OF(tst_large_share_slave)},
+		{ "tst_uchannel", "Tests & benchmarks the user-level message channels (SPSC & MPMC ring buffers)", PTR_START_OF(tst_uchannel_master)},
+		{ "uchannelSlave", "[Slave program] of tst_uchannel", PTR_START_OF(tst_uchannel_slave)},
 		/********************************************/
 		{ "tst_sleeplock", "Tests the acquire & release of sleep lock", PTR_START_OF(tst_sleeplock_master)},
 		{ "tstSleepLockSlave", "Slave program of tst_sleeplock", PTR_START_OF(tst_sleeplock_slave)},
@@ -146,6 +146,14 @@ DECLARE_START_OF(tst_chan_all_master);
 DECLARE_START_OF(tst_chan_all_slave);
 DECLARE_START_OF(tst_chan_one_master);
 DECLARE_START_OF(tst_chan_one_slave);
+DECLARE_START_OF(tst_sleep);
+DECLARE_START_OF(tst_sleep_slave);
+DECLARE_START_OF(tst_umutex_master);
+DECLARE_START_OF(tst_umutex_slave);
+DECLARE_START_OF(tst_large_share_master);
+DECLARE_START_OF(tst_large_share_slave);
+DECLARE_START_OF(tst_uchannel_master);
+DECLARE_START_OF(tst_uchannel_slave);
 /********************************************/
 DECLARE_START_OF(tst_sleeplock_master);
 DECLARE_START_OF(tst_sleeplock_slave);
@@ -0,0 +1,89 @@
+#include <inc/assert.h>
+#include <inc/disk.h>
+#include <inc/string.h>
+#include <inc/x86.h>
+#include "../mem/memory_manager.h"
+#include "../tests/tst_handler.h"
+
+//=================================================================
+// Test the IDE driver by commands of different sizes (1 page per command, ... up to
+// 32 pages = 256 sectors per command): the read back data are the written ones &
+// the throughput of each size
+// The original contents of the tested sectors (inside the page file) are saved
+// first & restored at the end, so run it while no env is using the page file
+// Usage: tst disk
+//=================================================================
+#define TST_DISK_PAGES		64					//(order 6 block)
+#define TST_DISK_MAX_CMD	32					//max pages per command (order 5 block)
+#define TST_DISK_START_SEC	90157
+
+//kernel VA of the given page of a block of contiguous frames
+#define TST_DISK_VA(block, pg)	((uint32*)(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(block)) + (pg) * PAGE_SIZE))
+static int tst_disk_rw(struct FrameInfo *block, uint32 secno, uint32 numOfPages, bool isWrite)
+{
+	struct ide_segment segs[TST_DISK_MAX_CMD];
+	for (uint32 s = 0; s < numOfPages; s++)
+	{
+		segs[s].va = TST_DISK_VA(block, s);
+		segs[s].nsecs = PAGE_SIZE / SECTSIZE;
+	}
+	return isWrite ? ide_writev(secno, segs, numOfPages) : ide_readv(secno, segs, numOfPages);
+}
+
+int tst_disk(int number_of_arguments, char **arguments)
+{
+	struct FrameInfo *saved, *src, *dst;
+	uint32 freeFramesBefore = num_of_free_frames();
+	if (allocate_frames(6, &saved) != 0 || allocate_frames(5, &src) != 0 || allocate_frames(5, &dst) != 0)
+		panic("tst_disk: failed to allocate the buffers");
+
+	//1. save the original contents
+	for (int p = 0; p < TST_DISK_PAGES; p += TST_DISK_MAX_CMD)
+		if (tst_disk_rw(&saved[p], TST_DISK_START_SEC + p * 8, TST_DISK_MAX_CMD, 0) != 0)
+			panic("tst_disk: failed to save the sectors at %d", TST_DISK_START_SEC + p * 8);
+
+	for (int pagesPerCmd = 1; pagesPerCmd <= TST_DISK_MAX_CMD; pagesPerCmd *= 2)
+	{
+		//2. the disk page # p is written from the source page # (p % pagesPerCmd), its contents
+		//	 depend on the round too (so the ones of the previous round can't pass the check)
+		for (int pg = 0; pg < pagesPerCmd; pg++)
+		{
+			uint32 *ptr = TST_DISK_VA(src, pg);
+			for (int j = 0; j < PAGE_SIZE / 4; j++)
+				ptr[j] = (pagesPerCmd << 24) | (pg << 16) | j;
+		}
+		uint64 t0 = read_tsc();
+		for (int p = 0; p < TST_DISK_PAGES; p += pagesPerCmd)
+			if (tst_disk_rw(src, TST_DISK_START_SEC + p * 8, pagesPerCmd, 1) != 0)
+				panic("tst_disk: failed to write %d pages at sector %d", pagesPerCmd, TST_DISK_START_SEC + p * 8);
+		uint64 t1 = read_tsc();
+
+		//3. read them back & compare
+		uint64 readCycles = 0;
+		for (int p = 0; p < TST_DISK_PAGES; p += pagesPerCmd)
+		{
+			memset(TST_DISK_VA(dst, 0), 0, pagesPerCmd * PAGE_SIZE);
+			uint64 t2 = read_tsc();
+			if (tst_disk_rw(dst, TST_DISK_START_SEC + p * 8, pagesPerCmd, 0) != 0)
+				panic("tst_disk: failed to read %d pages at sector %d", pagesPerCmd, TST_DISK_START_SEC + p * 8);
+			readCycles += read_tsc() - t2;
+			if (memcmp(TST_DISK_VA(dst, 0), TST_DISK_VA(src, 0), pagesPerCmd * PAGE_SIZE) != 0)
+				panic("tst_disk: wrong data are read back from sector %d by %d pages/cmd", TST_DISK_START_SEC + p * 8, pagesPerCmd);
+		}
+		cprintf("ide throughput: %2d pages/cmd: write = %u cycles/page, read = %u cycles/page\n",
+				pagesPerCmd, (uint32)((t1 - t0) / TST_DISK_PAGES), (uint32)(readCycles / TST_DISK_PAGES));
+	}
+
+	//4. restore the original contents
+	for (int p = 0; p < TST_DISK_PAGES; p += TST_DISK_MAX_CMD)
+		if (tst_disk_rw(&saved[p], TST_DISK_START_SEC + p * 8, TST_DISK_MAX_CMD, 1) != 0)
+			panic("tst_disk: failed to restore the sectors at %d", TST_DISK_START_SEC + p * 8);
+	free_frames(saved, 6);
+	free_frames(src, 5);
+	free_frames(dst, 5);
+	if (num_of_free_frames() != freeFramesBefore)
+		panic("tst_disk: wrong num of free frames at the end. Expected %d, Actual %d", freeFramesBefore, num_of_free_frames());
+
+	cprintf("Congratulations!! test disk completed successfully.\n");
+	return 0;
+}
@@ -0,0 +1,348 @@
+#include <inc/assert.h>
+#include <inc/string.h>
+#include <inc/x86.h>
+#include "../mem/memory_manager.h"
+#include "../tests/tst_handler.h"
+
+//=================================================================
+// Test the buddy allocator of the physical frames:
+// alignment of the blocks, splitting, merging & the free frames count
+// Usage: tst buddy
+//=================================================================
+int tst_buddy(int number_of_arguments, char **arguments)
+{
+	struct FrameInfo *blocks[MAX_FRAME_ORDER + 1];
+	uint32 freeFramesBefore = num_of_free_frames();
+
+	//1. allocate a block of each order
+	for (int order = 0; order <= MAX_FRAME_ORDER; order++)
+	{
+		if (allocate_frames(order, &blocks[order]) != 0)
+			panic("tst_buddy: failed to allocate a block of order %d", order);
+		if (to_frame_number(blocks[order]) % (1 << order) != 0)
+			panic("tst_buddy: block of order %d is not aligned (frame # %d)", order, to_frame_number(blocks[order]));
+		for (int i = 0; i < (1 << order); i++)
+			if (blocks[order][i].references != 0 || blocks[order][i].isFreeBlock)
+				panic("tst_buddy: frame %d of the block of order %d is not initialized", i, order);
+	}
+	uint32 allocated = (1 << (MAX_FRAME_ORDER + 1)) - 1;
+	if (num_of_free_frames() != freeFramesBefore - allocated)
+		panic("tst_buddy: wrong num of free frames after allocation. Expected %d, Actual %d", freeFramesBefore - allocated, num_of_free_frames());
+
+	//2. the blocks are not overlapped
+	for (int a = 0; a <= MAX_FRAME_ORDER; a++)
+		for (int b = a + 1; b <= MAX_FRAME_ORDER; b++)
+		{
+			uint32 sa = to_frame_number(blocks[a]), sb = to_frame_number(blocks[b]);
+			if (sa < sb + (1 << b) && sb < sa + (1 << a))
+				panic("tst_buddy: blocks of order %d & %d are overlapped", a, b);
+		}
+
+	//3. invalid order
+	struct FrameInfo *ptr_fi;
+	if (allocate_frames(MAX_FRAME_ORDER + 1, &ptr_fi) != E_INVAL)
+		panic("tst_buddy: allocating a block of order > MAX_FRAME_ORDER should fail");
+
+	//4. free a block frame by frame (it should be merged back as a whole, maybe with its buddies)
+	uint32 first = to_frame_number(blocks[3]);
+	for (int i = 0; i < 8; i++)
+		free_frame(&blocks[3][i]);
+	drain_frame_cache();		//(the single frames are freed to the cache of this CPU first)
+	int merged = 0;
+	for (int order = 3; order <= MAX_FRAME_ORDER && !merged; order++)
+	{
+		struct FrameInfo *ptr_head = &frames_info[first & ~((1 << order) - 1)];
+		merged = ptr_head->isFreeBlock && ptr_head->order == order;
+	}
+	if (!merged)
+		panic("tst_buddy: the frames of the freed block are not merged back (frame # %d)", first);
+
+	//5. free the others (the free frames count & the largest free block are restored)
+	for (int order = 0; order <= MAX_FRAME_ORDER; order++)
+		if (order != 3)
+			free_frames(blocks[order], order);
+	if (num_of_free_frames() != freeFramesBefore)
+		panic("tst_buddy: wrong num of free frames after free. Expected %d, Actual %d", freeFramesBefore, num_of_free_frames());
+	struct freeFramesCounters counters = calculate_available_frames();
+	if (counters.freeNotBuffered + counters.freeBuffered != freeFramesBefore)
+		panic("tst_buddy: calculate_available_frames() is not consistent with the free lists");
+	if (counters.largestFreeOrder != MAX_FRAME_ORDER)
+		panic("tst_buddy: the largest free block should be of order %d after free. Actual %d", MAX_FRAME_ORDER, counters.largestFreeOrder);
+
+	cprintf("Congratulations!! test buddy completed successfully.\n");
+	return 0;
+}
+
+//=================================================================
+// Test the pool of the pre-zeroed frames: the idle-time filling zeroes the freed (dirty)
+// frames, the free frames count is not affected by filling the pool, the frames are
+// taken from the pool & the cost of taking a zeroed frame from the pool vs. zeroing it
+// synchronously
+// Usage: tst zeroed
+//=================================================================
+#define TST_ZEROED_FRAMES	16
+static bool tst_zeroed_is_zero(struct FrameInfo *ptr_frame_info)
+{
+	uint32 *p = STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(ptr_frame_info));
+	for (int j = 0; j < PAGE_SIZE / 4; j++)
+		if (p[j] != 0)
+			return 0;
+	return 1;
+}
+
+int tst_zeroed(int number_of_arguments, char **arguments)
+{
+	struct FrameInfo *frames[TST_ZEROED_FRAMES], *dirty[TST_ZEROED_FRAMES];
+	struct FrameInfo *held[ZEROED_POOL_SIZE];
+	uint32 freeFramesBefore = num_of_free_frames();
+
+	//1. empty the pool (its frames are held till the end)
+	int numOfHeld = 0;
+	while (num_of_zeroed_frames() > 0 && numOfHeld < ZEROED_POOL_SIZE)
+		allocate_frame_zeroed(&held[numOfHeld++]);
+	if (num_of_zeroed_frames() != 0)
+		panic("tst_zeroed: failed to empty the pool. %d frames are left", num_of_zeroed_frames());
+
+	//2. dirty some frames then free them: they're on top of the (emptied) frame cache of
+	//	 this CPU, so they're the ones to be zeroed by the next filling of the pool
+	drain_frame_cache();
+	for (int i = 0; i < TST_ZEROED_FRAMES; i++)
+	{
+		allocate_frame(&dirty[i]);
+		memset(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(dirty[i])), 0xA5, PAGE_SIZE);
+	}
+	for (int i = 0; i < TST_ZEROED_FRAMES; i++)
+		free_frame(dirty[i]);
+
+	//3. fill the pool (as in the idle time): the same free frames count & the dirty frames are zeroed
+	uint32 freeFramesBeforeFill = num_of_free_frames();
+	fill_zeroed_frames(TST_ZEROED_FRAMES);
+	if (num_of_free_frames() != freeFramesBeforeFill)
+		panic("tst_zeroed: free frames count is changed by filling the pool. Expected %d, Actual %d", freeFramesBeforeFill, num_of_free_frames());
+	if (num_of_zeroed_frames() != TST_ZEROED_FRAMES)
+		panic("tst_zeroed: wrong num of frames in the pool after filling it. Expected %d, Actual %d", TST_ZEROED_FRAMES, num_of_zeroed_frames());
+	for (int i = 0; i < TST_ZEROED_FRAMES; i++)
+		if (!tst_zeroed_is_zero(dirty[i]))
+			panic("tst_zeroed: the dirty frame # %d is not zeroed by filling the pool", to_frame_number(dirty[i]));
+
+	//4. take the frames from the pool: they're the zeroed ones
+	uint64 t0 = read_tsc();
+	for (int i = 0; i < TST_ZEROED_FRAMES; i++)
+		allocate_frame_zeroed(&frames[i]);
+	uint64 t1 = read_tsc();
+	if (num_of_zeroed_frames() != 0)
+		panic("tst_zeroed: the frames are not taken from the pool. %d frames are left", num_of_zeroed_frames());
+	for (int i = 0; i < TST_ZEROED_FRAMES; i++)
+	{
+		bool found = 0;
+		for (int k = 0; k < TST_ZEROED_FRAMES && !found; k++)
+			found = (frames[i] == dirty[k]);
+		if (!found)
+			panic("tst_zeroed: frame # %d is not one of the zeroed frames of the pool", to_frame_number(frames[i]));
+		if (!tst_zeroed_is_zero(frames[i]))
+			panic("tst_zeroed: frame # %d is not zeroed", to_frame_number(frames[i]));
+		if (frames[i]->references != 0)
+			panic("tst_zeroed: frame # %d is not initialized", to_frame_number(frames[i]));
+	}
+	for (int i = 0; i < TST_ZEROED_FRAMES; i++)
+		free_frame(frames[i]);
+
+	//4. the same by synchronous zeroing (allocate_frame + memset)
+	uint64 t2 = read_tsc();
+	for (int i = 0; i < TST_ZEROED_FRAMES; i++)
+	{
+		allocate_frame(&frames[i]);
+		memset(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(frames[i])), 0, PAGE_SIZE);
+	}
+	uint64 t3 = read_tsc();
+	for (int i = 0; i < TST_ZEROED_FRAMES; i++)
+		free_frame(frames[i]);
+	for (int i = 0; i < numOfHeld; i++)
+		free_frame(held[i]);
+
+	if (num_of_free_frames() != freeFramesBefore)
+		panic("tst_zeroed: wrong num of free frames at the end. Expected %d, Actual %d", freeFramesBefore, num_of_free_frames());
+
+	cprintf("Avg cycles per zeroed frame: from the pool = %d, zeroed synchronously = %d\n",
+			(uint32)((t1 - t0) / TST_ZEROED_FRAMES), (uint32)((t3 - t2) / TST_ZEROED_FRAMES));
+	cprintf("Congratulations!! test zeroed completed successfully.\n");
+	return 0;
+}
+
+//=================================================================
+// Benchmark the page coloring: the cycles of reading a buffer of frames
+// (every cache line of each) that are given by the colored allocation of
+// consecutive pages vs. by the normal allocation (uncolored) vs. all of
+// the same color (the worst case)
+// Usage: tst coloring
+//=================================================================
+#define TST_COLORING_PAGES_PER_COLOR	8		//(num of ways of the L2 cache)
+#define TST_COLORING_MAX_FRAMES			(TST_COLORING_PAGES_PER_COLOR * 64)
+#define TST_COLORING_PASSES				32
+static struct FrameInfo *tst_coloring_frames[TST_COLORING_MAX_FRAMES];
+
+//Returns the avg cycles per pass over the given frames & sets the num of distinct colors among them
+static uint32 tst_coloring_run(int nframes, uint32 num_of_colors, uint32 *used_colors)
+{
+	uint8 used[MAX_FRAME_COLORS] = {0};
+	*used_colors = 0;
+	for (int i = 0; i < nframes; i++)
+	{
+		uint32 color = to_frame_number(tst_coloring_frames[i]) & (num_of_colors - 1);
+		if (!used[color])
+			(*used_colors)++;
+		used[color] = 1;
+	}
+
+	volatile uint32 sum = 0;
+	uint64 t0 = 0;
+	for (int pass = -1; pass < TST_COLORING_PASSES; pass++)
+	{
+		if (pass == 0)
+			t0 = read_tsc();		//(after a warm-up pass)
+		for (int i = 0; i < nframes; i++)
+		{
+			uint32 *p = STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(tst_coloring_frames[i]));
+			for (int j = 0; j < PAGE_SIZE / 4; j += 64 / 4)
+				sum += p[j];
+		}
+	}
+	return (uint32)((read_tsc() - t0) / TST_COLORING_PASSES);
+}
+
+int tst_coloring(int number_of_arguments, char **arguments)
+{
+	uint32 savedColors = get_num_of_frame_colors();
+	if (savedColors == 1)
+		set_num_of_frame_colors(DEF_FRAME_COLORS);
+	uint32 num_of_colors = get_num_of_frame_colors();
+	int nframes = num_of_colors * TST_COLORING_PAGES_PER_COLOR;
+	if (nframes > TST_COLORING_MAX_FRAMES)
+		nframes = TST_COLORING_MAX_FRAMES;
+	uint32 freeFramesBefore = num_of_free_frames();
+	uint32 cycles[3], used_colors[3];
+
+	//1. colored: consecutive pages get consecutive colors
+	for (int i = 0; i < nframes; i++)
+	{
+		allocate_frame_colored(&tst_coloring_frames[i], i * PAGE_SIZE, 0);
+		if (to_frame_number(tst_coloring_frames[i]) % num_of_colors != i % num_of_colors)
+			panic("tst_coloring: frame # %d of page %d is not of its color (%d)", to_frame_number(tst_coloring_frames[i]), i, i % num_of_colors);
+		if (tst_coloring_frames[i]->references != 0 || tst_coloring_frames[i]->isFreeBlock)
+			panic("tst_coloring: frame # %d is not initialized", to_frame_number(tst_coloring_frames[i]));
+	}
+	cycles[0] = tst_coloring_run(nframes, num_of_colors, &used_colors[0]);
+	for (int i = 0; i < nframes; i++)
+		free_frame(tst_coloring_frames[i]);
+
+	//2. uncolored: in the order of the free frames
+	for (int i = 0; i < nframes; i++)
+		allocate_frame(&tst_coloring_frames[i]);
+	cycles[1] = tst_coloring_run(nframes, num_of_colors, &used_colors[1]);
+	for (int i = 0; i < nframes; i++)
+		free_frame(tst_coloring_frames[i]);
+
+	//3. the same color
+	for (int i = 0; i < nframes; i++)
+		allocate_frame_colored(&tst_coloring_frames[i], 0, 0);
+	cycles[2] = tst_coloring_run(nframes, num_of_colors, &used_colors[2]);
+	for (int i = 0; i < nframes; i++)
+		free_frame(tst_coloring_frames[i]);
+
+	set_num_of_frame_colors(savedColors);
+	if (num_of_free_frames() != freeFramesBefore)
+		panic("tst_coloring: wrong num of free frames at the end. Expected %d, Actual %d", freeFramesBefore, num_of_free_frames());
+
+	cprintf("Avg cycles per pass over %d frames (%d colors): colored = %d (%d colors used), uncolored = %d (%d colors used), same color = %d\n",
+			nframes, num_of_colors, cycles[0], used_colors[0], cycles[1], used_colors[1], cycles[2]);
+	cprintf("Congratulations!! test coloring completed successfully.\n");
+	return 0;
+}
+
+//=================================================================
+// Test the pool of the page tables frames: the freed tables are reused,
+// they're zeroed (in the idle time or on allocation), the free frames
+// count is not affected by the pool & the cost of taking a table from
+// the pool vs. allocating & zeroing a frame
+// Usage: tst ptpool
+//=================================================================
+#define TST_PTPOOL_TABLES	16
+int tst_ptpool(int number_of_arguments, char **arguments)
+{
+	struct FrameInfo *tables[TST_PTPOOL_TABLES];
+	static struct FrameInfo *held[PT_POOL_SIZE];
+
+	//0. empty the pool (by taking its max size), so the freed tables of this test stay in it
+	for (int i = 0; i < PT_POOL_SIZE; i++)
+		allocate_page_table_frame(&held[i]);
+	uint32 freeFramesBefore = num_of_free_frames();
+
+	//1. allocate tables & fill them (like the tables of an env)
+	for (int i = 0; i < TST_PTPOOL_TABLES; i++)
+	{
+		allocate_page_table_frame(&tables[i]);
+		if (tables[i]->references != 1)
+			panic("tst_ptpool: references of table frame # %d should be 1", to_frame_number(tables[i]));
+		memset(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(tables[i])), 0x5A, PAGE_SIZE);
+	}
+	if (num_of_free_frames() != freeFramesBefore - TST_PTPOOL_TABLES)
+		panic("tst_ptpool: wrong num of free frames after allocation. Expected %d, Actual %d", freeFramesBefore - TST_PTPOOL_TABLES, num_of_free_frames());
+
+	//2. free them (like env_free): they're kept in the pool but counted as free
+	for (int i = 0; i < TST_PTPOOL_TABLES; i++)
+	{
+		tables[i]->references = 0;
+		free_page_table_frame(tables[i]);
+	}
+	if (num_of_free_frames() != freeFramesBefore)
+		panic("tst_ptpool: wrong num of free frames after free. Expected %d, Actual %d", freeFramesBefore, num_of_free_frames());
+
+	//3. zero half of them (as in the idle time), then allocate them again: the same frames, zeroed
+	clean_page_table_frames(TST_PTPOOL_TABLES / 2);
+	struct FrameInfo *reused[TST_PTPOOL_TABLES];
+	uint64 t0 = read_tsc();
+	for (int i = 0; i < TST_PTPOOL_TABLES; i++)
+		allocate_page_table_frame(&reused[i]);
+	uint64 t1 = read_tsc();
+	for (int i = 0; i < TST_PTPOOL_TABLES; i++)
+	{
+		int found = 0;
+		for (int j = 0; j < TST_PTPOOL_TABLES && !found; j++)
+			found = (reused[i] == tables[j]);
+		if (!found)
+			panic("tst_ptpool: table frame # %d is not reused from the pool", to_frame_number(reused[i]));
+		uint32 *pt = STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(reused[i]));
+		for (int j = 0; j < NPTENTRIES; j++)
+			if (pt[j] != 0)
+				panic("tst_ptpool: table frame # %d is not zeroed at entry %d", to_frame_number(reused[i]), j);
+	}
+	for (int i = 0; i < TST_PTPOOL_TABLES; i++)
+	{
+		reused[i]->references = 0;
+		free_page_table_frame(reused[i]);
+	}
+
+	//4. the same by allocating & zeroing a frame for each table
+	uint64 t2 = read_tsc();
+	for (int i = 0; i < TST_PTPOOL_TABLES; i++)
+	{
+		allocate_frame(&tables[i]);
+		memset(STATIC_KERNEL_VIRTUAL_ADDRESS(to_physical_address(tables[i])), 0, PAGE_SIZE);
+	}
+	uint64 t3 = read_tsc();
+	for (int i = 0; i < TST_PTPOOL_TABLES; i++)
+		free_frame(tables[i]);
+
+	if (num_of_free_frames() != freeFramesBefore)
+		panic("tst_ptpool: wrong num of free frames at the end. Expected %d, Actual %d", freeFramesBefore, num_of_free_frames());
+	for (int i = 0; i < PT_POOL_SIZE; i++)
+	{
+		held[i]->references = 0;
+		free_page_table_frame(held[i]);
+	}
+
+	cprintf("Avg cycles per page table: from the pool (half zeroed in idle time) = %d, allocated & zeroed = %d\n",
+			(uint32)((t1 - t0) / TST_PTPOOL_TABLES), (uint32)((t3 - t2) / TST_PTPOOL_TABLES));
+	cprintf("Congratulations!! test ptpool completed successfully.\n");
+	return 0;
+}
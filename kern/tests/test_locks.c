@@ -0,0 +1,72 @@
+#include <inc/assert.h>
+#include <inc/x86.h>
+#include <inc/string.h>
+#include <kern/conc/kspinlock.h>
+#include <kern/cpu/cpu.h>
+#include <kern/cpu/sched.h>
+#include "../mem/kheap.h"
+#include "../mem/memory_manager.h"
+#include "../tests/test_locks.h"
+#include "../tests/tst_handler.h"
+
+#define LOCKBENCH_DEF_ITERATIONS 100000
+
+//Return the avg num of cycles of an acquire/release pair of the given lock
+uint64 bench_kspinlock(struct kspinlock *lk, uint32 iterations)
+{
+	uint64 start = read_tsc();
+	for (uint32 i = 0; i < iterations; i++)
+	{
+		acquire_kspinlock(lk);
+		release_kspinlock(lk);
+	}
+	uint64 end = read_tsc();
+	return (end - start) / iterations;
+}
+
+//Check the FIFO order & the consistency of the tickets of the given lock
+static int check_tickets(struct kspinlock *lk)
+{
+	acquire_kspinlock(lk);
+	uint32 served = lk->now_serving;
+	int ok = (lk->next_ticket == served + 1 && lk->locked && holding_kspinlock(lk));
+	release_kspinlock(lk);
+	ok = ok && (lk->now_serving == served + 1) && (lk->next_ticket == lk->now_serving) && !lk->locked;
+	return ok;
+}
+
+//=================================================================
+// Benchmark the acquire/release path of the main kernel spinlocks
+// Usage: tst lockbench [num of iterations]
+// NOTE: NCPUS is 1 in this kernel, so it measures the uncontended (per-op) cost;
+// the cross-CPU contention needs the SMP bring-up (e.g. under QEMU -smp 4)
+//=================================================================
+int tst_lockbench(int number_of_arguments, char **arguments)
+{
+	uint32 iterations = LOCKBENCH_DEF_ITERATIONS;
+	if (number_of_arguments > 1)
+		iterations = strtol(arguments[1], NULL, 10);
+	if (iterations == 0)
+		iterations = LOCKBENCH_DEF_ITERATIONS;
+
+	struct kspinlock bench_lock;
+	init_kspinlock(&bench_lock, "bench lock");
+	if (!check_tickets(&bench_lock))
+		panic("tst_lockbench: wrong ticket state of the kspinlock");
+
+	cprintf("Avg cycles per acquire/release pair (%d iterations, %d CPU(s), pcs capture %s):\n",
+			iterations, NCPUS, KSPINLOCK_DEBUG ? "ON" : "OFF");
+	cprintf("\t%-20s %lld\n", "bench lock", bench_kspinlock(&bench_lock, iterations));
+	cprintf("\t%-20s %lld\n", "qlock", bench_kspinlock(&ProcessQueues.qlock, iterations));
+	cprintf("\t%-20s %lld\n", "mfllock", bench_kspinlock(&MemFrameLists.mfllock, iterations));
+	if (frame_lock.name[0] != '\0')
+		cprintf("\t%-20s %lld\n", "frame_lock", bench_kspinlock(&frame_lock, iterations));
+	else
+		cprintf("\t%-20s (not initialized: kheap is not in use)\n", "frame_lock");
+
+	if (!check_tickets(&ProcessQueues.qlock) || !check_tickets(&MemFrameLists.mfllock))
+		panic("tst_lockbench: wrong ticket state after the benchmark");
+
+	cprintf("Congratulations!! test lockbench completed successfully.\n");
+	return 0;
+}
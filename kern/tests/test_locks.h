@@ -0,0 +1,19 @@
+/*
+ * test_locks.h
+ *
+ *  Created on: Oct 18, 2025
+ */
+
+#ifndef KERN_TESTS_TEST_LOCKS_H_
+#define KERN_TESTS_TEST_LOCKS_H_
+
+#ifndef FOS_KERNEL
+#error "This is a FOS kernel header; user programs should not #include it"
+#endif
+
+#include <inc/types.h>
+#include <kern/conc/kspinlock.h>
+
+uint64 bench_kspinlock(struct kspinlock *lk, uint32 iterations);
+
+#endif
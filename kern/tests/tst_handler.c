@@ -40,6 +40,14 @@ struct Test tests[] = {
 		{"chunks","Test chunk manipulations", tst_chunks },
 		{"kheap", "Test KHEAP functions", tst_kheap},
 
+		//2025
+		{"lockbench", "Benchmark acquire/release of the kernel spinlocks (qlock, mfllock, frame_lock)", tst_lockbench},
+		{"buddy", "Test the buddy allocator of the physical frames (alignment, split, merge & free count)", tst_buddy},
+		{"zeroed", "Test the pool of the pre-zeroed frames (zeroed contents, free count & cost vs. synchronous zeroing)", tst_zeroed},
+		{"coloring", "Benchmark the page coloring of the frame allocator (colored vs. uncolored vs. same color frames)", tst_coloring},
+		{"ptpool", "Test the pool of the page tables frames (reuse, zeroing, free count & cost vs. allocating a table)", tst_ptpool},
+		{"disk", "Test the IDE driver by commands of different sizes (read back data & throughput)", tst_disk},
+
 };
 
 //Number of tests = size of the array / size of test structure
@@ -54,5 +54,13 @@ int tst_kheap(int number_of_arguments, char **arguments);
 /*2024*/
 int tst_priorityRR(int number_of_arguments, char **arguments);
 
+/*2025*/
+int tst_lockbench(int number_of_arguments, char **arguments);
+int tst_buddy(int number_of_arguments, char **arguments);
+int tst_zeroed(int number_of_arguments, char **arguments);
+int tst_coloring(int number_of_arguments, char **arguments);
+int tst_ptpool(int number_of_arguments, char **arguments);
+int tst_disk(int number_of_arguments, char **arguments);
+
 
 #endif /* KERN_TESTS_TST_HANDLER_H_ */
@@ -288,6 +288,25 @@ void sys_utilities(char* utilityName, int value)
 		}
 		release_kspinlock(&__tstchan_lk__);
 	}
+	else if (strncmp(utilityName, "__SleepTimeout@", strlen("__SleepTimeout@")) == 0)
+	{
+		//sleep on the test channel for (at most) the given ms, value = ptr to the result of sleep_timeout()
+		int number_of_tokens;
+		char *tokens[MAX_ARGUMENTS];
+		strsplit(utilityName, "@", tokens, &number_of_tokens) ;
+		uint32 timeout_ms = strtol(tokens[1], NULL, 10);
+		if (__firstTimeSleep)
+		{
+			__firstTimeSleep = 0;
+			init_channel(&__tstchan__, "Test Channel");
+			init_kspinlock(&__tstchan_lk__, "Test Channel Lock");
+		}
+		acquire_kspinlock(&__tstchan_lk__);
+		{
+			*((int*) value) = sleep_timeout(&__tstchan__, &__tstchan_lk__, timeout_ms);
+		}
+		release_kspinlock(&__tstchan_lk__);
+	}
 	else if (strcmp(utilityName, "__WakeupOne__") == 0)
 	{
 		wakeup_one(&__tstchan__);
@@ -616,7 +635,7 @@ void scarce_memory()
 	int fflSize = 0;
 	acquire_kspinlock(&MemFrameLists.mfllock);
 	{
-		fflSize = LIST_SIZE(&MemFrameLists.free_frame_list);
+		fflSize = num_of_free_frames();
 
 		uint32 size_of_already_allocated = number_of_frames - fflSize ;
 		uint32 size_tobe_allocated = total_size_tobe_allocated - size_of_already_allocated;
@@ -12,6 +12,7 @@
 #include <kern/disk/pagefile_manager.h>
 #include <kern/mem/memory_manager.h>
 #include <kern/mem/kheap.h>
+#include <kern/mem/shared_memory_manager.h>
 
  //2014 Test Free(): Set it to bypass the PAGE FAULT on an instruction with this length and continue executing the next one
  // 0 means don't bypass the PAGE FAULT
@@ -159,6 +160,17 @@ void fault_handler(struct Trapframe* tf)
 	}
 	else
 	{
+		/*2025: a large (4MB) page is always present, so it's an access violation (e.g. write on a read-only share)*/
+		if (userTrap && is_large_page_mapped(faulted_env->env_page_directory, fault_va))
+		{
+			env_exit();
+		}
+		/*2025: first touch of a page of a lazily-attached shared object*/
+		if (userTrap && share_lazy_fault(faulted_env, fault_va) == 0)
+		{
+			tlbflush();
+			return;
+		}
 		if (userTrap)
 		{
 			/*============================================================================================*/
@@ -343,6 +355,16 @@ int get_optimal_num_faults(struct WS_List* initWorkingSet, int maxWSSize, struct
 }
 
 
+//2025: the frame of a faulted page: if the page is not in the page file (i.e. its first touch)
+//it's a pre-zeroed frame, so it's not zeroed on the fault path. It has the color of the page
+//(if page coloring is on), so the consecutive pages don't compete for the same L2 sets
+static struct FrameInfo* alloc_faulted_frame(struct Env* faulted_env, uint32 va)
+{
+	struct FrameInfo* ptr_frame_info = NULL;
+	allocate_frame_colored(&ptr_frame_info, va, !pf_is_env_page_exist(faulted_env, va));
+	return ptr_frame_info;
+}
+
 void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 {
 #if USE_KHEAP
@@ -417,7 +439,7 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 		if (!yoyo_frame)
 		{
 			
-			allocate_frame(&yoyo_frame);
+			yoyo_frame = alloc_faulted_frame(faulted_env, yoyo_va);
 			map_frame(faulted_env->env_page_directory, yoyo_frame, yoyo_va, PERM_PRESENT | PERM_USER | PERM_WRITEABLE);
 			
 			int yoyo_rd = pf_read_env_page(faulted_env, (void*)yoyo_va);
@@ -426,7 +448,7 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 				if ((yoyo_va >= USTACKBOTTOM && yoyo_va < USTACKTOP) ||
 					(yoyo_va >= USER_HEAP_START && yoyo_va < USER_HEAP_MAX))
 				{
-					memset((void*)yoyo_va, 0, PAGE_SIZE);
+					//already zeroed (by alloc_faulted_frame)
 				}
 				else
 				{
@@ -455,7 +477,7 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 			uint32 newVirtualAddress = ROUNDDOWN(fault_va, PAGE_SIZE);
 		
 			struct FrameInfo* newFrame = NULL;
-			allocate_frame(&newFrame);
+			newFrame = alloc_faulted_frame(faulted_env, newVirtualAddress);
 		
 			uint32 perms = PERM_PRESENT | PERM_USER | PERM_WRITEABLE;
 			if (newVirtualAddress >= USER_HEAP_START && newVirtualAddress < USER_HEAP_MAX)
@@ -470,7 +492,7 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 				if ((newVirtualAddress >= USTACKBOTTOM && newVirtualAddress < USTACKTOP) ||
 					(newVirtualAddress >= USER_HEAP_START && newVirtualAddress < USER_HEAP_MAX))
 				{
-					memset((void*)newVirtualAddress, 0, PAGE_SIZE);
+					//already zeroed (by alloc_faulted_frame)
 				}
 				else
 				{
@@ -589,7 +611,7 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 				//cprintf("Unmapped frame from VA %x\n", oldVirtualAdd);
 				
 				// b mk frame we b mapping
-				allocate_frame(&victFrame);
+				victFrame = alloc_faulted_frame(faulted_env, newVirtualAdd);
 				map_frame(faulted_env->env_page_directory, victFrame, newVirtualAdd,
 					PERM_PRESENT | PERM_USER | PERM_WRITEABLE | PERM_UHPAGE);
 
@@ -599,7 +621,7 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 				if (redPage == E_PAGE_NOT_EXIST_IN_PF)
 				{
 					//cprintf("Clock Fault at VA %x\n", newVirtualAdd);
-					memset((void*)newVirtualAdd, 0, PAGE_SIZE);
+					//already zeroed (by alloc_faulted_frame)
 				}
 				else if (redPage != 0)
 				{
@@ -650,11 +672,11 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 				pt_clear_page_table_entry(faulted_env->env_page_directory,oVA);
 				tlb_invalidate(faulted_env->env_page_directory,(void*)oVA);
 
-				allocate_frame(&vF);
+				vF = alloc_faulted_frame(faulted_env, nVA);
 				map_frame(faulted_env->env_page_directory,vF,nVA,PERM_PRESENT|PERM_USER|PERM_WRITEABLE|PERM_UHPAGE);
 
 				int rP=pf_read_env_page(faulted_env,(void*)nVA);
-				if(rP==E_PAGE_NOT_EXIST_IN_PF){memset((void*)nVA,0,PAGE_SIZE);}
+				//(if rP==E_PAGE_NOT_EXIST_IN_PF, it's already zeroed by alloc_faulted_frame)
 
 				victimWSElement->virtual_address=nVA;
 				victimWSElement->empty=0;
@@ -721,11 +743,11 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 				pt_clear_page_table_entry(faulted_env->env_page_directory, oVA);
 				tlb_invalidate(faulted_env->env_page_directory, (void*)oVA);
 
-				allocate_frame(&vF);
+				vF = alloc_faulted_frame(faulted_env, nVA);
 				map_frame(faulted_env->env_page_directory,vF,nVA,PERM_PRESENT|PERM_USER|PERM_WRITEABLE|PERM_UHPAGE);
 
 				int rP=pf_read_env_page(faulted_env,(void*)nVA);
-				if(rP==E_PAGE_NOT_EXIST_IN_PF){memset((void*)nVA,0,PAGE_SIZE);}
+				//(if rP==E_PAGE_NOT_EXIST_IN_PF, it's already zeroed by alloc_faulted_frame)
 
 				victimWSElement->virtual_address=nVA;
 				victimWSElement->empty=0;
@@ -741,9 +763,8 @@ void page_fault_handler(struct Env* faulted_env, uint32 fault_va)
 			}
 		}
 	}
-	}
 #endif
-
+}
 
 
 void __page_fault_handler_with_buffering(struct Env* curenv, uint32 fault_va)
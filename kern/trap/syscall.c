@@ -13,6 +13,8 @@
 #include <kern/conc/channel.h>
 #include <kern/cpu/sched.h>
 #include <kern/cpu/cpu.h>
+#include <kern/cpu/timer_wheel.h>
+#include <kern/conc/futex.h>
 #include <kern/disk/pagefile_manager.h>
 #include <kern/mem/memory_manager.h>
 #include <kern/mem/shared_memory_manager.h>
@@ -251,7 +253,7 @@ void sys_clearFFL()
 	int size;
 	acquire_kspinlock(&MemFrameLists.mfllock);
 	{
-		size = LIST_SIZE(&MemFrameLists.free_frame_list) ;
+		size = num_of_free_frames() ;
 		struct FrameInfo* ptr_tmp_FI ;
 		for (int i = 0; i < size ; i++)
 		{
@@ -455,8 +457,14 @@ static void sys_exit_env()
 
 //New update in 2020
 //Create a new env & add it to the NEW queue
-int sys_create_env(char* programName, unsigned int page_WS_size,unsigned int LRU_second_list_size, unsigned int percent_WS_pages_to_remove)
+//2025: the env joins the given group of co-scheduled envs (0: no group)
+int sys_create_env(char* programName, unsigned int page_WS_size,unsigned int LRU_second_list_size, unsigned int percent_WS_pages_to_remove, int32 groupID)
 {
+	if (groupID < 0)
+	{
+		return E_INVAL;
+	}
+
 	//cprintf("\nAttempt to create a new env\n");
 
 	struct Env* env =  env_create(programName, page_WS_size, LRU_second_list_size, percent_WS_pages_to_remove);
@@ -464,6 +472,7 @@ int sys_create_env(char* programName, unsigned int page_WS_size,unsigned int LRU
 	{
 		return E_ENV_CREATION_ERROR;
 	}
+	env->group_id = groupID;
 	//cprintf("\nENV %d is created\n", env->env_id);
 
 	//2015
@@ -532,6 +541,33 @@ void sys_env_set_priority(int32 envID, int priority){
 		return;
 }
 
+/*2025*/
+//Block the current env for (at least) the given milliseconds
+void sys_sleep(uint32 milliseconds)
+{
+	timer_sleep(milliseconds);
+}
+
+//Slow paths of the user-level semaphores (keyed by the shared frame of the count)
+int sys_sem_wait(void* count)
+{
+	return sem_block(count);
+}
+int sys_sem_signal(void* count)
+{
+	return sem_wakeup(count);
+}
+
+//Generic futex: block while *addr == expected / wakeup (at most) num waiters on addr
+int sys_futex_wait(void* addr, int32 expected)
+{
+	return futex_wait(addr, expected);
+}
+int sys_futex_wake(void* addr, uint32 num)
+{
+	return futex_wake(addr, num);
+}
+
 // Dispatches to the correct kernel function, passing the arguments.
 uint32 syscall(uint32 syscallno, uint32 a1, uint32 a2, uint32 a3, uint32 a4, uint32 a5)
 {
@@ -550,6 +586,22 @@ uint32 syscall(uint32 syscallno, uint32 a1, uint32 a2, uint32 a3, uint32 a4, uin
 			sys_env_set_priority(a1,a2);
 			return 0;
 			break;
+	case SYS_sleep:
+		sys_sleep(a1);
+		return 0;
+		break;
+	case SYS_sem_wait:
+		return sys_sem_wait((void*)a1);
+		break;
+	case SYS_sem_signal:
+		return sys_sem_signal((void*)a1);
+		break;
+	case SYS_futex_wait:
+		return sys_futex_wait((void*)a1, (int32)a2);
+		break;
+	case SYS_futex_wake:
+		return sys_futex_wake((void*)a1, a2);
+		break;
 	//=============================================
 	case SYS_allocate_user_mem:
 		sys_allocate_user_mem(a1, a2);
@@ -641,7 +693,7 @@ uint32 syscall(uint32 syscallno, uint32 a1, uint32 a2, uint32 a3, uint32 a4, uin
 		break;
 
 	case SYS_create_env:
-		return sys_create_env((char*)a1, (uint32)a2, (uint32)a3, (uint32)a4);
+		return sys_create_env((char*)a1, (uint32)a2, (uint32)a3, (uint32)a4, (int32)a5);
 		break;
 
 	case SYS_run_env:
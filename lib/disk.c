@@ -4,6 +4,10 @@
  * see the materials available on the class references page.
  *
  * 2024: INTERRUPT-based is added to the IDE driver code (el7 :))
+ * 2025: bus-master DMA (PIIX) is added: the controller moves the sectors to/from
+ *       the frames of the buffer by itself & the env is blocked till IRQ14
+ * 2025: READ/WRITE MULTIPLE (one wait/IRQ per block of sectors instead of per sector)
+ *       & LBA48 (beyond 128GB & up to 65536 sectors per command)
  */
 
 #include <inc/disk.h>
@@ -11,17 +15,288 @@
 #include <inc/trap.h>
 #include <kern/trap/trap.h>
 #include <kern/proc/user_environment.h>
+#include <kern/mem/memory_manager.h>
 
 #define IDE_BSY		0x80
 #define IDE_DRDY	0x40
 #define IDE_DF		0x20
+#define IDE_DRQ		0x08
 #define IDE_ERR		0x01
 
+//ATA commands
+#define IDE_CMD_READ			0x20
+#define IDE_CMD_READ_EXT		0x24
+#define IDE_CMD_WRITE			0x30
+#define IDE_CMD_WRITE_EXT		0x34
+#define IDE_CMD_READ_MULTIPLE		0xC4
+#define IDE_CMD_READ_MULTIPLE_EXT	0x29
+#define IDE_CMD_WRITE_MULTIPLE		0xC5
+#define IDE_CMD_WRITE_MULTIPLE_EXT	0x39
+#define IDE_CMD_SET_MULTIPLE		0xC6
+#define IDE_CMD_IDENTIFY		0xEC
+
+#define IDE_MAX_MULTIPLE		16		//max sectors per block of READ/WRITE MULTIPLE to ask for
+#define IDE_LBA28_MAX_SECS		256
+#define IDE_LBA48_MAX_SECS		65536
+
 static int diskno = 0;
+static uint32 ide_multiple = 1;		//sectors per block of READ/WRITE MULTIPLE (1: not supported, use READ/WRITE)
+static bool ide_lba48 = 0;			//LBA48 commands are supported
+static int ide_wait_ready(bool check_error);
+
+//Write the task file registers & the command. The LBA48 (EXT) command is used only if
+//it's needed (beyond LBA28 range or > 256 sectors), since it costs more port writes
+static void ide_issue(uint32 secno, uint32 nsecs, uint8 cmd, uint8 cmd_ext)
+{
+	if (ide_lba48 && (nsecs > IDE_LBA28_MAX_SECS || secno + nsecs > (1 << 28)))
+	{
+		//high bytes (count & LBA 24..47) first then the low ones
+		outb(0x1F2, (nsecs >> 8) & 0xFF);
+		outb(0x1F3, (secno >> 24) & 0xFF);
+		outb(0x1F4, 0);
+		outb(0x1F5, 0);
+		outb(0x1F2, nsecs & 0xFF);
+		outb(0x1F3, secno & 0xFF);
+		outb(0x1F4, (secno >> 8) & 0xFF);
+		outb(0x1F5, (secno >> 16) & 0xFF);
+		outb(0x1F6, 0x40 | ((diskno&1)<<4));
+		outb(0x1F7, cmd_ext);
+	}
+	else
+	{
+		assert(nsecs <= IDE_LBA28_MAX_SECS && secno + nsecs <= (1 << 28));
+		outb(0x1F2, nsecs);
+		outb(0x1F3, secno & 0xFF);
+		outb(0x1F4, (secno >> 8) & 0xFF);
+		outb(0x1F5, (secno >> 16) & 0xFF);
+		outb(0x1F6, 0xE0 | ((diskno&1)<<4) | ((secno>>24)&0x0F));
+		outb(0x1F7, cmd);
+	}
+}
+
+//Ask the disk about its features (by IDENTIFY) & negotiate the multiple mode (by SET MULTIPLE MODE)
+//Called at boot, so it polls the status (no env to block)
+static void ide_identify()
+{
+	uint16 id[256];
+	int r;
+	outb(0x1F6, 0xE0 | ((diskno&1)<<4));
+	outb(0x1F7, IDE_CMD_IDENTIFY);
+	if (inb(0x1F7) == 0)
+		return;								//no disk
+	//the data are ready when BSY is cleared & DRQ is set, an aborted command sets ERR instead
+	while (((r = inb(0x1F7)) & IDE_BSY) || (r & (IDE_DRQ|IDE_DF|IDE_ERR)) == 0)
+		/* do nothing */;
+	if (r & (IDE_DF|IDE_ERR))
+		return;								//IDENTIFY is not supported, keep the defaults
+	insl(0x1F0, id, SECTSIZE/4);
+
+	ide_lba48 = (id[83] & (1 << 10)) != 0;
+
+	//word 47: max sectors per block of READ/WRITE MULTIPLE (power of 2)
+	uint32 multiple = id[47] & 0xFF;
+	if (multiple > IDE_MAX_MULTIPLE)
+		multiple = IDE_MAX_MULTIPLE;
+	if (multiple > 1)
+	{
+		outb(0x1F2, multiple);
+		outb(0x1F6, 0xE0 | ((diskno&1)<<4));
+		outb(0x1F7, IDE_CMD_SET_MULTIPLE);
+		while (((r = inb(0x1F7)) & (IDE_BSY|IDE_DRDY)) != IDE_DRDY)
+			/* do nothing */;
+		if ((r & (IDE_DF|IDE_ERR)) == 0)
+			ide_multiple = multiple;
+	}
+}
+
+#if DISK_IO_METHOD == DMA_BUS_MASTER
+//PCI configuration space
+#define PCI_CONFIG_ADDR		0xCF8
+#define PCI_CONFIG_DATA		0xCFC
+#define PCI_CLASS_REG		0x08
+#define PCI_COMMAND_REG		0x04
+#define PCI_BAR4_REG		0x20
+#define PCI_CMD_IO			0x1
+#define PCI_CMD_BUS_MASTER	0x4
+
+//Bus-master IDE registers (primary channel, offsets from BAR4)
+#define BM_COMMAND		0x0
+#define BM_STATUS		0x2
+#define BM_PRDT			0x4
+#define BM_CMD_START	0x01
+#define BM_CMD_READ		0x08		//direction: device -> memory
+#define BM_STS_ACTIVE	0x01
+#define BM_STS_ERR		0x02
+#define BM_STS_INTR		0x04
+
+#define IDE_CMD_READ_DMA		0xC8
+#define IDE_CMD_READ_DMA_EXT	0x25
+#define IDE_CMD_WRITE_DMA		0xCA
+#define IDE_CMD_WRITE_DMA_EXT	0x35
+#define IDE_DMA_MAX_SECS		256			//(limited by the PRD table below)
+
+//Physical Region Descriptor: a physically-contiguous part of the buffer
+//(MUST not cross a 64KB boundary, count 0 means 64KB)
+struct ide_prd
+{
+	uint32 addr;
+	uint16 count;
+	uint16 flags;
+};
+#define PRD_EOT			0x8000		//last entry of the table
+#define IDE_MAX_PRDS	64			//(256 sectors = 128KB in page-aligned buffers needs 32 page-sized entries)
+
+//The table is 4-byte aligned & (being 512 bytes aligned to 512) never crosses a 64KB boundary
+static struct ide_prd prdt[IDE_MAX_PRDS] __attribute__((aligned(IDE_MAX_PRDS * sizeof(struct ide_prd))));
+static uint16 bmide_base = 0;		//0: no bus-master controller found (use PROGRAMMED_IO)
+static volatile uint8 dma_done = 0;
+static volatile uint8 dma_status = 0;
+
+static uint32 pci_conf_read(uint32 bus, uint32 dev, uint32 func, uint32 off)
+{
+	outl(PCI_CONFIG_ADDR, 0x80000000 | (bus << 16) | (dev << 11) | (func << 8) | (off & 0xFC));
+	return inl(PCI_CONFIG_DATA);
+}
+
+static void pci_conf_write(uint32 bus, uint32 dev, uint32 func, uint32 off, uint32 val)
+{
+	outl(PCI_CONFIG_ADDR, 0x80000000 | (bus << 16) | (dev << 11) | (func << 8) | (off & 0xFC));
+	outl(PCI_CONFIG_DATA, val);
+}
+
+//Search bus 0 for a bus-master capable IDE controller (e.g. the PIIX3 IDE function of QEMU),
+//enable its bus mastering & return the I/O base of its bus-master registers (0 if not found)
+static uint16 ide_find_bus_master()
+{
+	for (uint32 dev = 0; dev < 32; dev++)
+	{
+		for (uint32 func = 0; func < 8; func++)
+		{
+			if ((pci_conf_read(0, dev, func, 0) & 0xFFFF) == 0xFFFF)
+				continue;					//no device
+			uint32 class = pci_conf_read(0, dev, func, PCI_CLASS_REG);
+			//class 01 (mass storage), subclass 01 (IDE), prog-if bit 7 (bus master)
+			if ((class >> 16) != 0x0101 || (class & 0x8000) == 0)
+				continue;
+			uint32 bar4 = pci_conf_read(0, dev, func, PCI_BAR4_REG);
+			if ((bar4 & 0x1) == 0 || (bar4 & ~0x3) == 0)
+				continue;					//not an I/O BAR
+			uint32 cmd = pci_conf_read(0, dev, func, PCI_COMMAND_REG);
+			pci_conf_write(0, dev, func, PCI_COMMAND_REG, (cmd & 0xFFFF) | PCI_CMD_IO | PCI_CMD_BUS_MASTER);
+			return bar4 & ~0x3;
+		}
+	}
+	return 0;
+}
+
+//Translate the given VA of the current address space to its PA
+static uint32 ide_virtual_to_physical(uint32 va)
+{
+	uint32 *ptr_directory = STATIC_KERNEL_VIRTUAL_ADDRESS(rcr3());
+	uint32 pde = ptr_directory[PDX(va)];
+	if ((pde & PERM_PRESENT) == 0)
+		panic("ide DMA: buffer VA %x is not mapped", va);
+	if (pde & PTE_PS)
+		return (pde & ~(PTSIZE - 1)) | (va & (PTSIZE - 1));
+	uint32 *ptr_table = STATIC_KERNEL_VIRTUAL_ADDRESS(EXTRACT_ADDRESS(pde));
+	uint32 pte = ptr_table[PTX(va)];
+	if ((pte & PERM_PRESENT) == 0)
+		panic("ide DMA: buffer VA %x is not mapped", va);
+	return EXTRACT_ADDRESS(pte) | PGOFF(va);
+}
+
+//Fill the PRD table by the (page-sized) physical parts of the given buffers
+static void ide_build_prdt(struct ide_segment *segs, uint32 nsegs)
+{
+	int n = 0;
+	for (uint32 s = 0; s < nsegs; s++)
+	{
+		uint32 va = (uint32)segs[s].va;
+		uint32 size = segs[s].nsecs * SECTSIZE;
+		while (size > 0)
+		{
+			uint32 len = PAGE_SIZE - PGOFF(va);
+			if (len > size)
+				len = size;
+			if (n == IDE_MAX_PRDS)
+				panic("ide DMA: too many physical parts of the buffers");
+			prdt[n].addr = ide_virtual_to_physical(va);
+			prdt[n].count = len;
+			prdt[n].flags = 0;
+			n++;
+			va += len;
+			size -= len;
+		}
+	}
+	prdt[n-1].flags = PRD_EOT;
+}
+
+//Transfer the given sectors between the disk & the buffer by DMA
+//The env (if any) is blocked till the controller raises IRQ14 at the end
+static int ide_dma(uint32 secno, struct ide_segment *segs, uint32 nsegs, uint32 nsecs, bool isWrite)
+{
+	uint8 dir = isWrite ? 0 : BM_CMD_READ;
+	ide_build_prdt(segs, nsegs);
+	outl(bmide_base + BM_PRDT, STATIC_KERNEL_PHYSICAL_ADDRESS(prdt));
+	outb(bmide_base + BM_COMMAND, dir);
+	outb(bmide_base + BM_STATUS, BM_STS_INTR | BM_STS_ERR);		//write 1 to clear them
+	dma_done = 0;
+
+	ide_wait_ready(0);
+	ide_issue(secno, nsecs, isWrite ? IDE_CMD_WRITE_DMA : IDE_CMD_READ_DMA, isWrite ? IDE_CMD_WRITE_DMA_EXT : IDE_CMD_READ_DMA_EXT);
+
+	uint8 status;
+	if (get_cpu_proc() != NULL)
+	{
+		//hold the lock (interrupts off) from the start till sleeping, so the IRQ can't be missed
+		acquire_kspinlock(&DISKlock);
+		outb(bmide_base + BM_COMMAND, dir | BM_CMD_START);
+		while (!dma_done)
+			sleep(&DISKchannel, &DISKlock);
+		status = dma_status;
+		release_kspinlock(&DISKlock);
+	}
+	else
+	{
+		//no env to block (e.g. kernel in command prompt): poll the controller
+		outb(bmide_base + BM_COMMAND, dir | BM_CMD_START);
+		while (!dma_done && ((status = inb(bmide_base + BM_STATUS)) & BM_STS_INTR) == 0)
+			/* do nothing */;
+		if (dma_done)
+			status = dma_status;
+		outb(bmide_base + BM_STATUS, BM_STS_INTR | BM_STS_ERR);
+	}
+	outb(bmide_base + BM_COMMAND, 0);		//stop
+	int r = inb(0x1F7);						//(also acknowledges the device interrupt)
+	if ((status & BM_STS_ERR) || (r & (IDE_DF|IDE_ERR)))
+	{
+		panic("FAILURE to %s %d sectors by DMA: bus-master status = %x, device status = %x\n", isWrite ? "write" : "read", nsecs, status, r);
+		return -1;
+	}
+	return 0;
+}
+#endif
 
 void disk_interrupt_handler(struct Trapframe *tf)
 {
 	int r;
+#if DISK_IO_METHOD == DMA_BUS_MASTER
+	{
+		//end of a DMA transfer: acknowledge the device & the controller then wakeup the waiting env
+		r = inb(0x1F7);
+		uint8 status = inb(bmide_base + BM_STATUS);
+		if (status & BM_STS_INTR)
+		{
+			outb(bmide_base + BM_STATUS, BM_STS_INTR | BM_STS_ERR);
+			acquire_kspinlock(&DISKlock);
+			dma_status = status;
+			dma_done = 1;
+			wakeup_one(&DISKchannel);
+			release_kspinlock(&DISKlock);
+		}
+		return;
+	}
+#endif
 	//cprintf("\n>>>>>>>> DISK INTERRUPT <<<<<<<<<\n");
 	if (((r = inb(0x1F7)) & (IDE_BSY|IDE_DRDY)) != IDE_DRDY)
 	{
@@ -40,6 +315,7 @@ void disk_interrupt_handler(struct Trapframe *tf)
 
 void ide_init()
 {
+	ide_identify();
 	//irq_install_handler(15, &disk_interrupt_handler);
 #if DISK_IO_METHOD == INT_SLEEP
 	{
@@ -54,6 +330,17 @@ void ide_init()
 		init_ksemaphore(&DISKsem, 0, "DISK semaphore");
 		init_ksemaphore(&DISKmutex, 1, "DISK mutex");
 	}
+#elif DISK_IO_METHOD == DMA_BUS_MASTER
+	{
+		init_channel(&DISKchannel, "DISK channel");
+		init_kspinlock(&DISKlock, "DISK channel lock");
+		init_sleeplock(&DISKmutex, "DISK mutex");
+		bmide_base = ide_find_bus_master();
+		if (bmide_base != 0)
+			irq_install_handler(14, &disk_interrupt_handler);
+		else
+			cprintf("ide_init: no bus-master IDE controller is found, PROGRAMMED_IO will be used\n");
+	}
 #endif
 }
 
@@ -63,7 +350,8 @@ static int ide_wait_ready(bool check_error)
 	int r;
 	//cprintf("ide_wait_ready: begin\n");
 
-#if DISK_IO_METHOD == PROGRAMMED_IO
+#if DISK_IO_METHOD == PROGRAMMED_IO || DISK_IO_METHOD == DMA_BUS_MASTER
+	//(DMA: only the transfer itself blocks the env, see ide_dma())
 	while (((r = inb(0x1F7)) & (IDE_BSY|IDE_DRDY)) != IDE_DRDY)
 		/* do nothing */;
 #else
@@ -105,10 +393,20 @@ static int ide_wait_ready(bool check_error)
 }
 
 int	ide_read(uint32 secno, void *dst, uint32 nsecs)
+{
+	struct ide_segment seg = { dst, nsecs };
+	return ide_readv(secno, &seg, 1);
+}
+
+//Read consecutive sectors (starting from secno) into the given buffers (in order) by a single command
+int	ide_readv(uint32 secno, struct ide_segment *segs, uint32 nsegs)
 {
 	int r;
+	uint32 nsecs = 0;
+	for (uint32 s = 0; s < nsegs; s++)
+		nsecs += segs[s].nsecs;
 
-	assert(nsecs <= 256);
+	assert(nsecs <= (ide_lba48 ? IDE_LBA48_MAX_SECS : IDE_LBA28_MAX_SECS));
 
 	//TODODONE'24 el7: FUTURE NOTE: This BUSY-WAIT should be replaced by Interrupt to allow the OS to schedule another process till the device become ready [el7 :)]
 	struct Env* e = get_cpu_proc();
@@ -117,30 +415,42 @@ int	ide_read(uint32 secno, void *dst, uint32 nsecs)
 	{
 		LOG_STATMENT(cprintf("ide_read: %d before CS\n", e->env_id););
 
-#if DISK_IO_METHOD == INT_SLEEP
+#if DISK_IO_METHOD == INT_SLEEP || DISK_IO_METHOD == DMA_BUS_MASTER
 		acquire_sleeplock(&DISKmutex);
 #elif DISK_IO_METHOD == INT_SEMAPHORE
 		wait_ksemaphore(&DISKmutex);
 #endif
 	}
+#if DISK_IO_METHOD == DMA_BUS_MASTER
+	if (bmide_base != 0 && nsecs <= IDE_DMA_MAX_SECS)
+	{
+		if (e) LOG_STATMENT(cprintf("ide_read: %d inside CS (DMA)\n", e->env_id););
+		ide_dma(secno, segs, nsegs, nsecs, 0);
+	}
+	else
+#endif
 	{
 		if (e) LOG_STATMENT(cprintf("ide_read: %d inside CS\n", e->env_id););
 		ide_wait_ready(0);
 
-		outb(0x1F2, nsecs);
-		outb(0x1F3, secno & 0xFF);
-		outb(0x1F4, (secno >> 8) & 0xFF);
-		outb(0x1F5, (secno >> 16) & 0xFF);
-		outb(0x1F6, 0xE0 | ((diskno&1)<<4) | ((secno>>24)&0x0F));
-		outb(0x1F7, 0x20);	// CMD 0x20 means read sector
+		//READ MULTIPLE: the disk is ready (i.e. a wait/IRQ) once per block of ide_multiple sectors
+		if (ide_multiple > 1)
+			ide_issue(secno, nsecs, IDE_CMD_READ_MULTIPLE, IDE_CMD_READ_MULTIPLE_EXT);
+		else
+			ide_issue(secno, nsecs, IDE_CMD_READ, IDE_CMD_READ_EXT);
 
-		for (; nsecs > 0; nsecs--, dst += SECTSIZE) {
-			if ((r = ide_wait_ready(1)) < 0)
-			{
-				panic("FAILURE to read %d sectors to disk\n",nsecs);
-				return r;
+		uint32 i = 0;
+		for (uint32 s = 0; s < nsegs; s++)
+		{
+			void *dst = segs[s].va;
+			for (uint32 n = segs[s].nsecs; n > 0; n--, nsecs--, dst += SECTSIZE, i++) {
+				if (i % ide_multiple == 0 && (r = ide_wait_ready(1)) < 0)
+				{
+					panic("FAILURE to read %d sectors to disk\n",nsecs);
+					return r;
+				}
+				insl(0x1F0, dst, SECTSIZE/4);
 			}
-			insl(0x1F0, dst, SECTSIZE/4);
 		}
 	}
 	/*If there's env, Exit the Critical Section */
@@ -148,7 +458,7 @@ int	ide_read(uint32 secno, void *dst, uint32 nsecs)
 	{
 		LOG_STATMENT(cprintf("ide_read: %d Left CS\n", e->env_id););
 
-#if DISK_IO_METHOD == INT_SLEEP
+#if DISK_IO_METHOD == INT_SLEEP || DISK_IO_METHOD == DMA_BUS_MASTER
 		release_sleeplock(&DISKmutex);
 #elif DISK_IO_METHOD == INT_SEMAPHORE
 		signal_ksemaphore(&DISKmutex);
@@ -159,11 +469,21 @@ int	ide_read(uint32 secno, void *dst, uint32 nsecs)
 }
 
 int ide_write(uint32 secno, const void *src, uint32 nsecs)
+{
+	struct ide_segment seg = { (void*)src, nsecs };
+	return ide_writev(secno, &seg, 1);
+}
+
+//Write the given buffers (in order) into consecutive sectors (starting from secno) by a single command
+int ide_writev(uint32 secno, struct ide_segment *segs, uint32 nsegs)
 {
 	int r;
+	uint32 nsecs = 0;
+	for (uint32 s = 0; s < nsegs; s++)
+		nsecs += segs[s].nsecs;
 
 	//LOG_STATMENT(cprintf("1 ==> nsecs = %d\n",nsecs);)
-	assert(nsecs <= 256);
+	assert(nsecs <= (ide_lba48 ? IDE_LBA48_MAX_SECS : IDE_LBA28_MAX_SECS));
 
 	struct Env* e = get_cpu_proc();
 	/*If there's env, Critical Section to ensure that the entire read/write will be completely finished*/
@@ -171,7 +491,7 @@ int ide_write(uint32 secno, const void *src, uint32 nsecs)
 	{
 		LOG_STATMENT(cprintf("ide_write: %d before CS\n", e->env_id););
 
-#if DISK_IO_METHOD == INT_SLEEP
+#if DISK_IO_METHOD == INT_SLEEP || DISK_IO_METHOD == DMA_BUS_MASTER
 		//cprintf("ide_write: before acquire_sleeplock\n");
 		acquire_sleeplock(&DISKmutex);
 		//cprintf("ide_write: after acquire_sleeplock\n");
@@ -179,38 +499,49 @@ int ide_write(uint32 secno, const void *src, uint32 nsecs)
 		wait_ksemaphore(&DISKmutex);
 #endif
 	}
+#if DISK_IO_METHOD == DMA_BUS_MASTER
+	if (bmide_base != 0 && nsecs <= IDE_DMA_MAX_SECS)
+	{
+		if (e) LOG_STATMENT(cprintf("ide_write: %d inside CS (DMA)\n", e->env_id););
+		ide_dma(secno, segs, nsegs, nsecs, 1);
+	}
+	else
+#endif
 	{
 		if (e) LOG_STATMENT(cprintf("ide_write: %d inside CS\n", e->env_id););
 
 		ide_wait_ready(0);
 
 		//LOG_STATMENT(cprintf("3 ==> nsecs = %d\n",nsecs);)
-		outb(0x1F2, nsecs);
-		outb(0x1F3, secno & 0xFF);
-		outb(0x1F4, (secno >> 8) & 0xFF);
-		outb(0x1F5, (secno >> 16) & 0xFF);
-		outb(0x1F6, 0xE0 | ((diskno&1)<<4) | ((secno>>24)&0x0F));
-		outb(0x1F7, 0x30);	// CMD 0x30 means write sector
-
+		//WRITE MULTIPLE: the disk asks for data (i.e. a wait/IRQ) once per block of ide_multiple sectors
+		if (ide_multiple > 1)
+			ide_issue(secno, nsecs, IDE_CMD_WRITE_MULTIPLE, IDE_CMD_WRITE_MULTIPLE_EXT);
+		else
+			ide_issue(secno, nsecs, IDE_CMD_WRITE, IDE_CMD_WRITE_EXT);
 
-		for (; nsecs > 0; nsecs--, src += SECTSIZE) {
-			if ((r = ide_wait_ready(1)) < 0)
-			{
-				panic("FAILURE to write %d sectors to disk\n",nsecs);
-				LOG_STATMENT(cprintf("FAILURE to write %d sectors to disk\n",nsecs););
-				return r;
-			}
-			else
-			{
-				outsl(0x1F0, src, SECTSIZE/4);
-				//LOG_STATMENT(cprintf("written %d sectors to disk successfully\n",nsecs););
+		uint32 i = 0;
+		for (uint32 s = 0; s < nsegs; s++)
+		{
+			const void *src = segs[s].va;
+			for (uint32 n = segs[s].nsecs; n > 0; n--, nsecs--, src += SECTSIZE, i++) {
+				if (i % ide_multiple == 0 && (r = ide_wait_ready(1)) < 0)
+				{
+					panic("FAILURE to write %d sectors to disk\n",nsecs);
+					LOG_STATMENT(cprintf("FAILURE to write %d sectors to disk\n",nsecs););
+					return r;
+				}
+				else
+				{
+					outsl(0x1F0, src, SECTSIZE/4);
+					//LOG_STATMENT(cprintf("written %d sectors to disk successfully\n",nsecs););
+				}
 			}
 		}
 	}
 	/*If there's env, Exit the Critical Section */
 	if (e)
 	{
-#if DISK_IO_METHOD == INT_SLEEP
+#if DISK_IO_METHOD == INT_SLEEP || DISK_IO_METHOD == DMA_BUS_MASTER
 		release_sleeplock(&DISKmutex);
 #elif DISK_IO_METHOD == INT_SEMAPHORE
 		signal_ksemaphore(&DISKmutex);
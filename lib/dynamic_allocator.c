@@ -13,6 +13,7 @@
 #include <kern/proc/user_environment.h>
 #include <kern/cpu/sched.h>
 #include <kern/conc/kspinlock.h>
+#include <kern/cpu/sched_trace.h>
 #endif
 
 
@@ -211,12 +212,18 @@ void *alloc_block(uint32 size)
 	//TODO: [PROJECT'25.BONUS#1] DYNAMIC ALLOCATOR - block if no free block
 	if (holding_kspinlock(&frame_lock))
 	{
-		release_kspinlock(&frame_lock);
+		//block like sleep(): counted in ProcessQueues.num_of_blocked, so the scheduler idles
+		//(instead of returning to the prompt) till a free_block() wakes it up
 		struct Env* curenv = get_cpu_proc();
+		acquire_kspinlock(&ProcessQueues.qlock);
 		curenv->env_status = ENV_BLOCKED;
 		LIST_INSERT_TAIL(&alloc_wait_queue, curenv);
+		ProcessQueues.num_of_blocked++;
+		sched_trace(curenv, STRC_BLOCK);
+		release_kspinlock(&frame_lock);
 		sched();
 		acquire_kspinlock(&frame_lock);
+		release_kspinlock(&ProcessQueues.qlock);
 		return alloc_block(size);
 	}
 	else
@@ -308,12 +315,17 @@ void free_block(void *va)
 		    //panic("free_block() Not implemented yet");
 
 #if FOS_KERNEL
+			acquire_kspinlock(&ProcessQueues.qlock);
 			if (!LIST_EMPTY(&alloc_wait_queue))
 			{
 				struct Env* waiter = LIST_FIRST(&alloc_wait_queue);
 				LIST_REMOVE(&alloc_wait_queue, waiter);
+				waiter->env_status = ENV_READY;
+				ProcessQueues.num_of_blocked--;
+				sched_trace(waiter, STRC_WAKEUP);
 				sched_insert_ready(waiter);
 			}
+			release_kspinlock(&ProcessQueues.qlock);
 #endif
 }
 
@@ -1,24 +1,63 @@
 // User-level Semaphore
+//
+// The semaphore data lives in a shared object (smalloc) so that all the envs
+// that get it (sget) operate on the same count. The count is updated atomically
+// in user space; a negative count is the num of envs that are (or about to be)
+// blocked. So, the kernel is entered only to block a waiter or to wake one
+// up (sys_sem_wait/sys_sem_signal are keyed by the shared frame of the count).
 
 #include "inc/lib.h"
 
 struct semaphore create_semaphore(char *semaphoreName, uint32 value)
 {
-	panic("create_semaphore() is not implemented yet...!!");
+	struct semaphore sem;
+	sem.semdata = smalloc(semaphoreName, sizeof(struct __semdata), 1);
+	if (sem.semdata == NULL)
+		panic("create_semaphore: failed to create the shared object of semaphore %s", semaphoreName);
+
+	//the queue of the blocked envs is kept by the kernel (not used here)
+	sem.semdata->queue.lh_first = NULL;
+	sem.semdata->queue.lh_last = NULL;
+	sem.semdata->queue.size = 0;
+	sem.semdata->count = value;
+	sem.semdata->lock = 0;
+	strncpy(sem.semdata->name, semaphoreName, sizeof(sem.semdata->name) - 1);
+	sem.semdata->name[sizeof(sem.semdata->name) - 1] = '\0';
+	return sem;
 }
 struct semaphore get_semaphore(int32 ownerEnvID, char* semaphoreName)
 {
-	panic("get_semaphore() is not implemented yet...!!");
+	struct semaphore sem;
+	sem.semdata = sget(ownerEnvID, semaphoreName);
+	if (sem.semdata == NULL)
+		panic("get_semaphore: semaphore %s of env %d is not exist", semaphoreName, ownerEnvID);
+	return sem;
 }
 
 void wait_semaphore(struct semaphore sem)
 {
-	panic("wait_semaphore() is not implemented yet...!!");
+	//Fast path: the semaphore is available
+	if (xadd(&(sem.semdata->count), -1) > 0)
+		return;
+
+	//Slow path: block in the kernel till a signal
+	//(it fails only if the count is not mapped, the decrement is not undone then since a
+	// signaler may have already counted this waiter)
+	int ret = sys_sem_wait(&(sem.semdata->count));
+	if (ret != 0)
+		panic("wait_semaphore: failed to block on semaphore %s (error %d)", sem.semdata->name, ret);
 }
 
 void signal_semaphore(struct semaphore sem)
 {
-	panic("signal_semaphore() is not implemented yet...!!");
+	//Fast path: no waiters
+	if (xadd(&(sem.semdata->count), 1) >= 0)
+		return;
+
+	//Slow path: wakeup one of the waiters
+	int ret = sys_sem_signal(&(sem.semdata->count));
+	if (ret != 0)
+		panic("signal_semaphore: failed to wakeup a waiter of semaphore %s (error %d)", sem.semdata->name, ret);
 }
 
 int semaphore_count(struct semaphore sem)
@@ -145,6 +145,12 @@ int sys_create_env(char* programName, unsigned int page_WS_size,unsigned int LRU
 	return syscall(SYS_create_env,(uint32)programName, (uint32)page_WS_size,(uint32)LRU_second_list_size, (uint32)percent_WS_pages_to_remove, 0);
 }
 
+//2025: same as sys_create_env() but the new env joins the given group (of co-scheduled envs)
+int sys_create_env_in_group(char* programName, unsigned int page_WS_size,unsigned int LRU_second_list_size,unsigned int percent_WS_pages_to_remove, int32 groupID)
+{
+	return syscall(SYS_create_env,(uint32)programName, (uint32)page_WS_size,(uint32)LRU_second_list_size, (uint32)percent_WS_pages_to_remove, (uint32)groupID);
+}
+
 void sys_run_env(int32 envId)
 {
 	syscall(SYS_run_env, (int32)envId, 0, 0, 0, 0);
@@ -298,3 +304,29 @@ void sys_env_set_priority(int32 envID, int priority)
 }
 //=============================================
 
+/*2025*/
+void sys_sleep(uint32 milliseconds)
+{
+	syscall(SYS_sleep, milliseconds, 0, 0, 0, 0);
+	return ;
+}
+
+int sys_sem_wait(volatile int32* count)
+{
+	return syscall(SYS_sem_wait, (uint32)count, 0, 0, 0, 0);
+}
+
+int sys_sem_signal(volatile int32* count)
+{
+	return syscall(SYS_sem_signal, (uint32)count, 0, 0, 0, 0);
+}
+
+int sys_futex_wait(volatile int32* addr, int32 expected)
+{
+	return syscall(SYS_futex_wait, (uint32)addr, (uint32)expected, 0, 0, 0);
+}
+
+int sys_futex_wake(volatile int32* addr, uint32 num)
+{
+	return syscall(SYS_futex_wake, (uint32)addr, num, 0, 0, 0);
+}
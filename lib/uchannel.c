@@ -0,0 +1,171 @@
+// User-level message channel
+//
+// A bounded ring buffer of fixed-size messages that lives in a shared object
+// (smalloc) so that many envs can use it. Each slot carries a sequence number, so a
+// sender/receiver only needs to claim a position (an atomic cmpxchg on the tail/head
+// in MPMC, a plain store in SPSC) and never waits for the others while copying its
+// message. An env blocks in the kernel (sys_futex_wait) only when the channel is
+// full/empty, and the other side calls sys_futex_wake only if someone is blocked.
+#include "inc/lib.h"
+#include "inc/uchannel.h"
+
+static inline struct uchannel_slot* chan_slot(struct uchannel *ch, uint32 pos)
+{
+	return (struct uchannel_slot*)(ch->slots + (pos & (ch->capacity - 1)) * ch->slot_size);
+}
+
+//compiler barrier (x86 doesn't reorder stores with older stores nor loads with older loads)
+#define CHAN_BARRIER()	__asm __volatile("" : : : "memory")
+
+struct uchannel* chan_create(char *name, uint32 kind, uint32 msg_size, uint32 capacity)
+{
+	assert(kind == CHAN_SPSC || kind == CHAN_MPMC);
+	if (msg_size == 0 || capacity == 0 || (capacity & (capacity - 1)) != 0)
+		panic("chan_create: message size must be > 0 & capacity must be a power of 2");
+	uint32 slot_size = ROUNDUP(sizeof(struct uchannel_slot) + msg_size, sizeof(uint32));
+	struct uchannel *ch = smalloc(name, sizeof(struct uchannel) + capacity * slot_size, 1);
+	if (ch == NULL)
+		return NULL;
+	strcpy(ch->name, name);
+	ch->kind = kind;
+	ch->msg_size = msg_size;
+	ch->capacity = capacity;
+	ch->slot_size = slot_size;
+	ch->tail = ch->head = 0;
+	ch->data_seq = ch->space_seq = 0;
+	ch->recv_waiters = ch->send_waiters = 0;
+	for (uint32 i = 0; i < capacity; i++)
+		chan_slot(ch, i)->seq = i;
+	return ch;
+}
+
+struct uchannel* chan_get(int32 ownerEnvID, char *name)
+{
+	return sget(ownerEnvID, name);
+}
+
+// Send the message without blocking
+// Returns 0 on success, E_AGAIN if the channel is full
+int chan_try_send(struct uchannel *ch, const void *msg)
+{
+	struct uchannel_slot *slot;
+	uint32 pos = ch->tail;
+	while (1)
+	{
+		slot = chan_slot(ch, pos);
+		int32 dif = (int32)(slot->seq - pos);
+		if (dif < 0)
+			return E_AGAIN;					//not yet received since the last round: full
+		if (dif == 0)
+		{
+			if (ch->kind == CHAN_SPSC)
+			{
+				ch->tail = pos + 1;
+				break;
+			}
+			uint32 old = cmpxchg(&ch->tail, pos, pos + 1);
+			if (old == pos)
+				break;
+			pos = old;						//another sender claimed it
+		}
+		else
+			pos = ch->tail;
+	}
+	CHAN_BARRIER();
+	memcpy(slot->data, msg, ch->msg_size);
+	CHAN_BARRIER();
+	slot->seq = pos + 1;					//publish it
+
+	//wakeup a blocked receiver (if any). xadd is a full barrier, so the waiters are
+	//read after the publish (a receiver that's counted after it will see the message)
+	xadd((volatile int32*)&ch->data_seq, 1);
+	if (ch->recv_waiters > 0)
+		sys_futex_wake((volatile int32*)&ch->data_seq, 1);
+	return 0;
+}
+
+// Receive a message without blocking
+// Returns 0 on success, E_AGAIN if the channel is empty
+int chan_try_recv(struct uchannel *ch, void *msg)
+{
+	struct uchannel_slot *slot;
+	uint32 pos = ch->head;
+	while (1)
+	{
+		slot = chan_slot(ch, pos);
+		int32 dif = (int32)(slot->seq - (pos + 1));
+		if (dif < 0)
+			return E_AGAIN;					//not yet sent: empty
+		if (dif == 0)
+		{
+			if (ch->kind == CHAN_SPSC)
+			{
+				ch->head = pos + 1;
+				break;
+			}
+			uint32 old = cmpxchg(&ch->head, pos, pos + 1);
+			if (old == pos)
+				break;
+			pos = old;						//another receiver claimed it
+		}
+		else
+			pos = ch->head;
+	}
+	CHAN_BARRIER();
+	memcpy(msg, slot->data, ch->msg_size);
+	CHAN_BARRIER();
+	slot->seq = pos + ch->capacity;			//free it for the next round
+
+	xadd((volatile int32*)&ch->space_seq, 1);
+	if (ch->send_waiters > 0)
+		sys_futex_wake((volatile int32*)&ch->space_seq, 1);
+	return 0;
+}
+
+// Send the message, block while the channel is full
+void chan_send(struct uchannel *ch, const void *msg)
+{
+	for (int i = 0; i < CHAN_SPIN_COUNT; i++)
+	{
+		if (chan_try_send(ch, msg) == 0)
+			return;
+		cpu_pause();
+	}
+	while (1)
+	{
+		//read the futex word BEFORE the retry, so a receive after the retry changes
+		//it & the wait returns immediately (no lost wakeup)
+		int32 seq = ch->space_seq;
+		xadd(&ch->send_waiters, 1);
+		if (chan_try_send(ch, msg) == 0)
+		{
+			xadd(&ch->send_waiters, -1);
+			return;
+		}
+		sys_futex_wait((volatile int32*)&ch->space_seq, seq);
+		xadd(&ch->send_waiters, -1);
+	}
+}
+
+// Receive a message, block while the channel is empty
+void chan_recv(struct uchannel *ch, void *msg)
+{
+	for (int i = 0; i < CHAN_SPIN_COUNT; i++)
+	{
+		if (chan_try_recv(ch, msg) == 0)
+			return;
+		cpu_pause();
+	}
+	while (1)
+	{
+		int32 seq = ch->data_seq;
+		xadd(&ch->recv_waiters, 1);
+		if (chan_try_recv(ch, msg) == 0)
+		{
+			xadd(&ch->recv_waiters, -1);
+			return;
+		}
+		sys_futex_wait((volatile int32*)&ch->data_seq, seq);
+		xadd(&ch->recv_waiters, -1);
+	}
+}
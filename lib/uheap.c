@@ -192,6 +192,32 @@ void free(void* virtual_address)
     //Comment the following line
 	// panic("free() is not implemented yet...!!");
 }
+//2025: a large share (multiple of 4MB) is mapped by 4MB pages only if it starts
+//at a 4MB-aligned VA, so leave a free gap (usable by later allocations) to align
+//the break before extending it for such a share
+static void align_break_for_large_share(uint32 sz)
+{
+	if (sz % PTSIZE != 0 || uheapPageAllocBreak % PTSIZE == 0)
+		return;
+	uint32 gap = ROUNDUP(uheapPageAllocBreak, PTSIZE) - uheapPageAllocBreak;
+	if ((uint32)(USER_HEAP_MAX - uheapPageAllocBreak) < gap + sz)
+		return;
+	struct UHBlk *gapblk = alloc_block(sizeof(struct UHBlk));
+	if (gapblk == NULL) return;
+	gapblk->va = uheapPageAllocBreak;
+	gapblk->size = gap;
+	gapblk->is_free = 1;
+	gapblk->next = NULL;
+	if (UHBlkL == NULL) {
+		UHBlkL = gapblk;
+	} else {
+		struct UHBlk *t = UHBlkL;
+		while (t->next != NULL) t = t->next;
+		t->next = gapblk;
+	}
+	uheapPageAllocBreak += gap;
+}
+
 //=================================
 // [3] ALLOCATE SHARED VARIABLE:
 //=================================
@@ -277,6 +303,7 @@ void* smalloc(char *sharedVarName, uint32 size, uint8 isWritable)
 	        return (uint32*)worst->va;
 	    }
 	    // Extend break if possible (break < max)
+	    align_break_for_large_share(sz);
 	    if ((uint32)(USER_HEAP_MAX - uheapPageAllocBreak) >= sz) {
 	        struct UHBlk *nd_abdo = alloc_block(sizeof(struct UHBlk));
 	        if (nd_abdo == NULL) return NULL;
@@ -383,6 +410,7 @@ void* sget(int32 ownerEnvID, char *sharedVarName)
 		        return (void*)worst->va;
 		    }
 		    // Extend break if possible (break < max)
+		    align_break_for_large_share(sz);
 		    if ((uint32)(USER_HEAP_MAX - uheapPageAllocBreak) >= sz) {
 		        struct UHBlk *nd_abdo = alloc_block(sizeof(struct UHBlk));
 		        if (nd_abdo == NULL) return NULL;
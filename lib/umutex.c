@@ -0,0 +1,80 @@
+// User-level adaptive mutex
+//
+// The state is a futex word: 0 (unlocked), 1 (locked) or 2 (locked & may have
+// waiters). Acquiring a free mutex & releasing a mutex that nobody waits on are
+// done entirely in user space. A contended acquire spins for a short while (the
+// holder may release it soon) then blocks in the kernel by sys_futex_wait(); the
+// release wakes one waiter by sys_futex_wake() only if the state says so.
+// The mutex can be placed in a shared object (smalloc) to be used by many envs.
+#include "inc/lib.h"
+#include "inc/umutex.h"
+
+void init_umutex(struct umutex *mtx, char *name, bool isOpened)
+{
+	assert(isOpened == 0 || isOpened == 1);
+	strcpy(mtx->name, name);
+	mtx->state = isOpened ? UMUTEX_UNLOCKED : UMUTEX_LOCKED;
+}
+
+int try_acquire_umutex(struct umutex *mtx)
+{
+	return cmpxchg(&mtx->state, UMUTEX_UNLOCKED, UMUTEX_LOCKED) == UMUTEX_UNLOCKED;
+}
+
+// Acquire the mutex.
+void acquire_umutex(struct umutex *mtx)
+{
+	//Fast path: the mutex is free
+	uint32 c = cmpxchg(&mtx->state, UMUTEX_UNLOCKED, UMUTEX_LOCKED);
+	if (c != UMUTEX_UNLOCKED)
+	{
+		//Spin briefly: the holder may release it soon
+		for (int i = 0; i < UMUTEX_SPIN_COUNT; i++)
+		{
+			cpu_pause();
+			if (mtx->state == UMUTEX_UNLOCKED)
+			{
+				c = cmpxchg(&mtx->state, UMUTEX_UNLOCKED, UMUTEX_LOCKED);
+				if (c == UMUTEX_UNLOCKED)
+					break;
+			}
+		}
+	}
+	if (c != UMUTEX_UNLOCKED)
+	{
+		//Slow path: mark it as contended then block till it's released
+		//(the kernel re-checks the state before blocking, so a release
+		// in between can't be missed)
+		if (c != UMUTEX_CONTENDED)
+			c = xchg(&mtx->state, UMUTEX_CONTENDED);
+		while (c != UMUTEX_UNLOCKED)
+		{
+			sys_futex_wait((volatile int32*)&mtx->state, UMUTEX_CONTENDED);
+			c = xchg(&mtx->state, UMUTEX_CONTENDED);
+		}
+	}
+
+#if UMUTEX_TRACE
+	cprintf("[%d: %s] ACQUIRED mutex [%s]\n", myEnv->env_id, myEnv->prog_name, mtx->name);
+#endif
+}
+
+// Release the mutex.
+void release_umutex(struct umutex *mtx)
+{
+	if (mtx->state == UMUTEX_UNLOCKED)
+	{
+		panic("release: mutex \"%s\" is not held!", mtx->name);
+	}
+#if UMUTEX_TRACE
+	cprintf("[%d: %s] RELEASED mutex [%s]\n", myEnv->env_id, myEnv->prog_name, mtx->name);
+#endif
+
+	//Fast path: no waiters (LOCKED -> UNLOCKED)
+	if (xadd((volatile int32*)&mtx->state, -1) == UMUTEX_LOCKED)
+		return;
+
+	//Slow path: it was CONTENDED, free it & wakeup one waiter
+	xchg(&mtx->state, UMUTEX_UNLOCKED);
+	sys_futex_wake((volatile int32*)&mtx->state, 1);
+}
@@ -15,7 +15,7 @@ _main(void)
 		cprintf("%~Which type of concurrency protection do you want to use? \n") ;
 		cprintf("%~0) Nothing\n") ;
 		cprintf("%~1) Semaphores\n") ;
-		cprintf("%~2) SpinLock\n") ;
+		cprintf("%~2) Mutex (spin-then-block)\n") ;
 		cprintf("%~your choice (0, 1, 2): ") ;
 		select = getchar() ;
 		cputchar(select);
@@ -30,7 +30,7 @@ _main(void)
 	else if (select == '2') *protType = 2 ;
 
 	struct semaphore T, finished, finishedCountMutex;
-	struct uspinlock *sT, *sfinishedCountMutex;
+	struct umutex *sT, *sfinishedCountMutex;
 	int *numOfFinished ;
 	if (*protType == 1)
 	{
@@ -40,10 +40,10 @@ _main(void)
 	}
 	else if (*protType == 2)
 	{
-		sT = smalloc("T", sizeof(struct uspinlock), 1);
-		init_uspinlock(sT, "T", 0);
-		sfinishedCountMutex = smalloc("finishedCountMutex", sizeof(struct uspinlock), 1);
-		init_uspinlock(sfinishedCountMutex, "finishedCountMutex", 1);
+		sT = smalloc("T", sizeof(struct umutex), 1);
+		init_umutex(sT, "T", 0);
+		sfinishedCountMutex = smalloc("finishedCountMutex", sizeof(struct umutex), 1);
+		init_umutex(sfinishedCountMutex, "finishedCountMutex", 1);
 	}
 	//Create the check-finishing counter
 	numOfFinished = smalloc("finishedCount", sizeof(int), 1) ;
@@ -14,7 +14,7 @@ void _main(void)
 	int *finishedCount = sget(parentenvID, "finishedCount") ;
 
 	struct semaphore T, finished, finishedCountMutex ;
-	struct uspinlock *sT, *sfinishedCountMutex;
+	struct umutex *sT, *sfinishedCountMutex;
 
 	if (*protType == 1)
 	{
@@ -55,7 +55,7 @@ void _main(void)
 	}
 	else if (*protType == 2)
 	{
-		release_uspinlock(sT);
+		release_umutex(sT);
 	}
 	/*[3] DECLARE FINISHING*/
 	if (*protType == 1)
@@ -70,11 +70,11 @@ void _main(void)
 	}
 	else if (*protType == 2)
 	{
-		acquire_uspinlock(sfinishedCountMutex);
+		acquire_umutex(sfinishedCountMutex);
 		{
 			(*finishedCount)++ ;
 		}
-		release_uspinlock(sfinishedCountMutex);
+		release_umutex(sfinishedCountMutex);
 	}
 	else
 	{
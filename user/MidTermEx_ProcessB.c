@@ -13,7 +13,7 @@ void _main(void)
 	int *protType = sget(parentenvID, "protType") ;
 	int * finishedCount = sget(parentenvID, "finishedCount") ;
 	struct semaphore T, finished, finishedCountMutex ;
-	struct uspinlock *sT, *sfinishedCountMutex;
+	struct umutex *sT, *sfinishedCountMutex;
 
 	if (*protType == 1)
 	{
@@ -35,7 +35,7 @@ void _main(void)
 	}
 	else if (*protType == 2)
 	{
-		acquire_uspinlock(sT);
+		acquire_umutex(sT);
 	}
 
 	//random delay
@@ -70,11 +70,11 @@ void _main(void)
 	}
 	else if (*protType == 2)
 	{
-		acquire_uspinlock(sfinishedCountMutex);
+		acquire_umutex(sfinishedCountMutex);
 		{
 			(*finishedCount)++ ;
 		}
-		release_uspinlock(sfinishedCountMutex);
+		release_umutex(sfinishedCountMutex);
 	}else
 	{
 		sys_lock_cons();
@@ -29,9 +29,11 @@ _main(void)
 	/*[2] RUN THE SLAVES PROGRAMS*/
 	int numOfSlaveProgs = 3 ;
 
-	int32 envIdQuickSort = sys_create_env("slave_qs", (myEnv->page_WS_max_size),(myEnv->SecondListSize) ,(myEnv->percentage_of_WS_pages_to_be_removed));
-	int32 envIdMergeSort = sys_create_env("slave_ms", (myEnv->page_WS_max_size),(myEnv->SecondListSize), (myEnv->percentage_of_WS_pages_to_be_removed));
-	int32 envIdStats = sys_create_env("slave_stats", (myEnv->page_WS_max_size), (myEnv->SecondListSize),(myEnv->percentage_of_WS_pages_to_be_removed));
+	//the slaves share the same semaphores, so create them in one group to be co-scheduled
+	int32 groupID = sys_getenvid();
+	int32 envIdQuickSort = sys_create_env_in_group("slave_qs", (myEnv->page_WS_max_size),(myEnv->SecondListSize) ,(myEnv->percentage_of_WS_pages_to_be_removed), groupID);
+	int32 envIdMergeSort = sys_create_env_in_group("slave_ms", (myEnv->page_WS_max_size),(myEnv->SecondListSize), (myEnv->percentage_of_WS_pages_to_be_removed), groupID);
+	int32 envIdStats = sys_create_env_in_group("slave_stats", (myEnv->page_WS_max_size), (myEnv->SecondListSize),(myEnv->percentage_of_WS_pages_to_be_removed), groupID);
 
 	if (envIdQuickSort == E_ENV_CREATION_ERROR || envIdMergeSort == E_ENV_CREATION_ERROR || envIdStats == E_ENV_CREATION_ERROR)
 		panic("NO AVAILABLE ENVs...");
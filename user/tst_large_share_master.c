@@ -0,0 +1,41 @@
+// Benchmark the large (4MB) pages of the shared objects (run it once with "largeshare 1" and once with "largeshare 0")
+// Master program: create a 1024x1024 shared matrix (exactly 4MB), traverse it column by column
+// (each access is on a different 4KB page, so it's TLB-miss sensitive) then let a slave do the same on it
+#include <inc/lib.h>
+
+#define N			1024
+#define NUM_OF_ROUNDS	10
+
+void
+_main(void)
+{
+	int (*mat)[N] = smalloc("mat", N * N * sizeof(int), 1);
+	if (mat == NULL)
+		panic("failed to create the shared matrix");
+	for (int i = 0; i < N; i++)
+		for (int j = 0; j < N; j++)
+			mat[i][j] = i + j;
+	struct semaphore finished = create_semaphore("finished", 0);
+
+	struct uint64 timeBefore = sys_get_virtual_time();
+	int64 sum = 0;
+	for (int r = 0; r < NUM_OF_ROUNDS; r++)
+		for (int j = 0; j < N; j++)
+			for (int i = 0; i < N; i++)
+				sum += mat[i][j];
+	struct uint64 timeAfter = sys_get_virtual_time();
+
+	//sum of (i+j) over the matrix = N*N*(N-1)
+	if (sum != (int64)NUM_OF_ROUNDS * N * N * (N - 1))
+		panic("Error: wrong sum of the shared matrix");
+	cprintf("smalloc'ed at %x: column-wise traversal (%d rounds) took %d\n", mat, NUM_OF_ROUNDS, timeAfter.low - timeBefore.low);
+
+	int id = sys_create_env("largeShareSlave", (myEnv->page_WS_max_size),(myEnv->SecondListSize), 50);
+	if (id == E_ENV_CREATION_ERROR)
+		panic("NO AVAILABLE ENVs...");
+	sys_run_env(id);
+	wait_semaphore(finished);
+
+	cprintf("Congratulations!! Benchmark of the large shared pages completed successfully.\n");
+	return;
+}
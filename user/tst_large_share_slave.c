@@ -0,0 +1,32 @@
+// Benchmark the large (4MB) pages of the shared objects
+// Slave program: get the shared matrix, traverse it column by column then signal the master program
+#include <inc/lib.h>
+
+#define N			1024
+#define NUM_OF_ROUNDS	10
+
+void
+_main(void)
+{
+	int32 parentenvID = sys_getparentenvid();
+
+	int (*mat)[N] = sget(parentenvID, "mat");
+	if (mat == NULL)
+		panic("failed to get the shared matrix");
+	struct semaphore finished = get_semaphore(parentenvID, "finished");
+
+	struct uint64 timeBefore = sys_get_virtual_time();
+	int64 sum = 0;
+	for (int r = 0; r < NUM_OF_ROUNDS; r++)
+		for (int j = 0; j < N; j++)
+			for (int i = 0; i < N; i++)
+				sum += mat[i][j];
+	struct uint64 timeAfter = sys_get_virtual_time();
+
+	if (sum != (int64)NUM_OF_ROUNDS * N * N * (N - 1))
+		panic("Error: wrong sum of the shared matrix in the slave");
+	cprintf("sget at %x: column-wise traversal (%d rounds) took %d\n", mat, NUM_OF_ROUNDS, timeAfter.low - timeBefore.low);
+
+	signal_semaphore(finished);
+	return;
+}
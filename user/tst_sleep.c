@@ -0,0 +1,91 @@
+// Test the timed sleep (sys_sleep & sleep_timeout)
+// The env should be BLOCKED during the sleep, so it shouldn't consume CPU quantums,
+// and it should be woken up by the timer (timeout) or by a wakeup on its channel
+#include <inc/lib.h>
+
+//Wait (by timed sleeps) till the given env is blocked or the counter of the test reaches 'tst'
+//Returns 1 if it's blocked
+static int wait_blocked(int envID, uint32 tst)
+{
+	volatile struct Env* e = NULL;
+	for (int i = 0; i < NENV; i++)
+	{
+		if (envs[i].env_id == envID)
+		{
+			e = &envs[i];
+			break;
+		}
+	}
+	if (e == NULL)
+		return 0;
+	for (int i = 0; i < 1000 && gettst() < tst; i++)
+	{
+		if (e->env_status == ENV_BLOCKED)
+			return 1;
+		sys_sleep(10);
+	}
+	return 0;
+}
+
+void
+_main(void)
+{
+	int envID = sys_getenvid();
+
+	int numOfSleeps = 5;
+	uint32 sleepTime = 200 ; //ms
+	for (int i = 0; i < numOfSleeps; ++i)
+	{
+		uint32 clocksBefore = myEnv->nClocks;
+		struct uint64 timeBefore = sys_get_virtual_time();
+
+		sys_sleep(sleepTime);
+
+		uint32 clocksAfter = myEnv->nClocks;
+		struct uint64 timeAfter = sys_get_virtual_time();
+
+		//at most one clock can be counted on it (e.g. the one that exits it from the run)
+		if (clocksAfter - clocksBefore > 1)
+		{
+			panic("%~test sleep failed! env consumes %d quantums while sleeping", clocksAfter - clocksBefore);
+		}
+		if (timeAfter.hi == timeBefore.hi && timeAfter.low == timeBefore.low)
+		{
+			panic("%~test sleep failed! env is not blocked at all");
+		}
+		cprintf("%~sleep #%d is done\n", i+1);
+	}
+
+	//sleep_timeout() of another env: woken up by the timer then by a wakeup
+	int slaveID = sys_create_env("tstSleepSlave", (myEnv->page_WS_max_size),(myEnv->SecondListSize), (myEnv->percentage_of_WS_pages_to_be_removed));
+	if (slaveID == E_ENV_CREATION_ERROR)
+		panic("%~test sleep failed! can't create the slave");
+	sys_run_env(slaveID);
+
+	//1. it stays blocked on the channel till the timer wakes it up
+	if (!wait_blocked(slaveID, 1))
+		panic("%~test sleep failed! the slave is not blocked during its timed sleep");
+	int numOfBlocked = 0;
+	char cmd1[64] = "__GetChanQueueSize__";
+	sys_utilities(cmd1, (uint32)(&numOfBlocked));
+	if (numOfBlocked != 1)
+		panic("%~test sleep failed! the slave should be in the channel queue. Actual queue size = %d", numOfBlocked);
+	while (gettst() < 1)
+		sys_sleep(10);
+	cprintf("%~sleep till the timeout is done\n");
+
+	//2. wake it up before its timeout
+	if (!wait_blocked(slaveID, 2))
+		panic("%~test sleep failed! the slave is not blocked during its 2nd timed sleep");
+	char cmd2[64] = "__WakeupAll__";
+	sys_utilities(cmd2, 0);
+	for (int i = 0; i < 1000 && gettst() < 2; i++)
+		sys_sleep(10);
+	if (gettst() != 2)
+		panic("%~test sleep failed! the slave is not woken up by the wakeup");
+	cprintf("%~sleep till a wakeup is done\n");
+
+	cprintf_colored(TEXT_light_green, "%~\n\nCongratulations!! Test of timed sleep [%d] completed successfully!!\n\n", envID);
+
+	return;
+}
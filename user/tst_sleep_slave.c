@@ -0,0 +1,28 @@
+// Test the timed sleep on a channel (sleep_timeout)
+// Slave program: sleep till the timeout, then sleep till a wakeup (long timeout)
+#include <inc/lib.h>
+
+void
+_main(void)
+{
+	int envID = sys_getenvid();
+	int expired = -1;
+
+	//1. no wakeup: should be woken up by the timer
+	char cmd1[64] = "__SleepTimeout@300";
+	sys_utilities(cmd1, (uint32)(&expired));
+	if (expired != 1)
+		panic("%~test sleep failed! sleep_timeout should return 1 when woken up by the timer. Actual %d", expired);
+	inctst();
+
+	//2. the master wakes it up long before the timeout
+	expired = -1;
+	char cmd2[64] = "__SleepTimeout@60000";
+	sys_utilities(cmd2, (uint32)(&expired));
+	if (expired != 0)
+		panic("%~test sleep failed! sleep_timeout should return 0 when woken up by a wakeup. Actual %d", expired);
+	inctst();
+
+	cprintf_colored(TEXT_light_magenta, ">>> Slave %d is Finished\n", envID);
+	return;
+}
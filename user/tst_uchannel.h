@@ -0,0 +1,15 @@
+/*
+ * tst_uchannel.h
+ *
+ *  Shared between the master & slave programs of the user-level channels test
+ */
+
+#ifndef TST_UCHANNEL_H_
+#define TST_UCHANNEL_H_
+
+struct bench_cfg {
+	uint32 kind;			//kind of the channel of the current round
+	volatile int32 sum;		//sum of the received messages (by all slaves)
+};
+
+#endif /* TST_UCHANNEL_H_ */
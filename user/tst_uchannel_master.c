@@ -0,0 +1,54 @@
+// Test & benchmark the user-level message channels (ring buffers in shared objects)
+// Master program: for each kind of channel, send NUM_OF_MSGS messages to the slave(s),
+// then a stop message to each of them, and measure the time till they finish
+#include <inc/lib.h>
+#include <user/tst_uchannel.h>
+
+#define NUM_OF_MSGS		10000
+#define CAPACITY		64
+
+static void run_round(struct bench_cfg *cfg, uint32 kind, char *chanName, int numOfSlaves, struct semaphore finished)
+{
+	struct uchannel *ch = chan_create(chanName, kind, sizeof(int), CAPACITY);
+	if (ch == NULL)
+		panic("failed to create the channel %s", chanName);
+	cfg->kind = kind;
+	cfg->sum = 0;
+
+	for (int i = 0; i < numOfSlaves; i++)
+	{
+		int id = sys_create_env("uchannelSlave", (myEnv->page_WS_max_size),(myEnv->SecondListSize), 50);
+		if (id == E_ENV_CREATION_ERROR)
+			panic("NO AVAILABLE ENVs...");
+		sys_run_env(id);
+	}
+
+	struct uint64 timeBefore = sys_get_virtual_time();
+	for (int i = 1; i <= NUM_OF_MSGS; i++)
+		chan_send(ch, &i);
+	int stop = -1;
+	for (int i = 0; i < numOfSlaves; i++)
+		chan_send(ch, &stop);
+	for (int i = 0; i < numOfSlaves; i++)
+		wait_semaphore(finished);
+	struct uint64 timeAfter = sys_get_virtual_time();
+
+	if (cfg->sum != NUM_OF_MSGS * (NUM_OF_MSGS + 1) / 2)
+		panic("Error: sum of the received messages = %d, expected = %d", cfg->sum, NUM_OF_MSGS * (NUM_OF_MSGS + 1) / 2);
+	cprintf("%s: %d messages to %d receiver(s) took %d\n", chanName, NUM_OF_MSGS, numOfSlaves, timeAfter.low - timeBefore.low);
+}
+
+void
+_main(void)
+{
+	struct bench_cfg *cfg = smalloc("bench_cfg", sizeof(struct bench_cfg), 1);
+	if (cfg == NULL)
+		panic("failed to create the shared object bench_cfg");
+	struct semaphore finished = create_semaphore("finished", 0);
+
+	run_round(cfg, CHAN_SPSC, "chan_spsc", 1, finished);
+	run_round(cfg, CHAN_MPMC, "chan_mpmc", 2, finished);
+
+	cprintf("Congratulations!! Test of the user-level channels completed successfully.\n");
+	return;
+}
@@ -0,0 +1,35 @@
+// Test & benchmark the user-level message channels
+// Slave program: receive the messages till the stop one, add them to the shared sum then signal the master program
+#include <inc/lib.h>
+#include <user/tst_uchannel.h>
+
+void
+_main(void)
+{
+	int32 parentenvID = sys_getparentenvid();
+
+	struct bench_cfg *cfg = sget(parentenvID, "bench_cfg");
+	if (cfg == NULL)
+		panic("failed to get the shared object bench_cfg");
+	struct uchannel *ch = chan_get(parentenvID, cfg->kind == CHAN_SPSC ? "chan_spsc" : "chan_mpmc");
+	struct semaphore finished = get_semaphore(parentenvID, "finished");
+	if (ch == NULL)
+		panic("failed to get the channel");
+
+	int msg, last = 0, sum = 0;
+	while (1)
+	{
+		chan_recv(ch, &msg);
+		if (msg == -1)
+			break;
+		//a single receiver must get them in the sending order
+		if (ch->kind == CHAN_SPSC && msg != last + 1)
+			panic("Error: received %d after %d", msg, last);
+		last = msg;
+		sum += msg;
+	}
+	xadd(&cfg->sum, sum);
+
+	signal_semaphore(finished);
+	return;
+}
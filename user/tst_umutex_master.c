@@ -0,0 +1,37 @@
+// Test the user-level mutex (spin-then-block) for mutual exclusion
+// Master program: create the mutex & the shared counter, run slaves and wait them to finish
+#include <inc/lib.h>
+
+#define NUM_OF_SLAVES	3
+#define NUM_OF_INCS		1000
+
+void
+_main(void)
+{
+	struct umutex *mtx = smalloc("mtx", sizeof(struct umutex), 1);
+	init_umutex(mtx, "mtx", 1);
+	int *counter = smalloc("counter", sizeof(int), 1);
+	*counter = 0;
+	struct semaphore finished = create_semaphore("finished", 0);
+
+	int ids[NUM_OF_SLAVES];
+	for (int i = 0; i < NUM_OF_SLAVES; i++)
+	{
+		ids[i] = sys_create_env("umutexSlave", (myEnv->page_WS_max_size),(myEnv->SecondListSize), 50);
+		if (ids[i] == E_ENV_CREATION_ERROR)
+			panic("NO AVAILABLE ENVs...");
+	}
+	for (int i = 0; i < NUM_OF_SLAVES; i++)
+		sys_run_env(ids[i]);
+
+	for (int i = 0; i < NUM_OF_SLAVES; i++)
+		wait_semaphore(finished);
+
+	if (*counter != NUM_OF_SLAVES * NUM_OF_INCS)
+		panic("Error: counter = %d, expected = %d... please review the mutex code again...", *counter, NUM_OF_SLAVES * NUM_OF_INCS);
+	if (mtx->state != UMUTEX_UNLOCKED)
+		panic("Error: mutex is not released at the end [state = %d]", mtx->state);
+
+	cprintf("Congratulations!! Test of the user-level mutex completed successfully.\n");
+	return;
+}
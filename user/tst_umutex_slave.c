@@ -0,0 +1,31 @@
+// Test the user-level mutex (spin-then-block) for mutual exclusion
+// Slave program: increment the shared counter inside the critical section then signal the master program
+#include <inc/lib.h>
+
+#define NUM_OF_INCS		1000
+
+void
+_main(void)
+{
+	int32 parentenvID = sys_getparentenvid();
+
+	struct umutex *mtx = sget(parentenvID, "mtx");
+	int *counter = sget(parentenvID, "counter");
+	struct semaphore finished = get_semaphore(parentenvID, "finished");
+
+	for (int i = 0; i < NUM_OF_INCS; i++)
+	{
+		acquire_umutex(mtx);
+		{
+			//non-atomic read-modify-write: a lost update means the CS is violated
+			int c = *counter;
+			if (i % 100 == 0)
+				env_sleep(10);
+			*counter = c + 1;
+		}
+		release_umutex(mtx);
+	}
+
+	signal_semaphore(finished);
+	return;
+}